@@ -0,0 +1,356 @@
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <model/collision_detector.h>
+
+using namespace std::literals;
+namespace po = boost::program_options;
+namespace cd = collision_detector;
+
+namespace {
+
+// widths of the game: a dog is 0.6 wide, a loot is a point
+constexpr double GATHERER_WIDTH = 0.3;
+constexpr double ITEM_WIDTH = 0.0;
+// share and width of the wide items of the outlier distribution
+constexpr double OUTLIER_SHARE = 0.01;
+constexpr double OUTLIER_WIDTH = 10.0;
+
+struct Args {
+    std::vector<std::string> methods {"find", "try"};
+    std::vector<std::string> layouts {"random", "sweep"};
+    std::vector<std::string> widths {"game", "uniform", "outlier"};
+    std::vector<size_t> gatherers {100, 1000, 10000};
+    std::vector<size_t> items {100, 1000, 10000};
+    // items per square unit of the field
+    std::vector<double> densities {0.1, 10};
+    // length of a move of the random layout
+    double step {1.0};
+    // every case is repeated at least that long and at least min_repeats times
+    std::chrono::milliseconds min_time {200};
+    size_t min_repeats {3};
+    // brute force TryCollectPoint cases above that number of pairs are skipped
+    size_t max_try_pairs {100'000'000};
+    uint64_t seed {1};
+    bool csv {false};
+};
+
+struct Case {
+    std::string method;
+    std::string layout;
+    std::string widths;
+    double density;
+    size_t gatherers;
+    size_t items;
+
+    size_t Pairs() const {
+        return gatherers * items;
+    }
+};
+
+struct Result {
+    double ns_per_call;
+    size_t events;
+    size_t repeats;
+};
+
+template <typename T>
+std::vector<T> ParseList(const std::string& text) {
+    std::vector<T> values;
+    std::istringstream input{text};
+    std::string item;
+    while (std::getline(input, item, ',')) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            values.push_back(item);
+        }
+        else if constexpr (std::is_floating_point_v<T>) {
+            values.push_back(static_cast<T>(std::stod(item)));
+        }
+        else {
+            values.push_back(static_cast<T>(std::stoll(item)));
+        }
+    }
+    if (values.empty()) {
+        throw std::runtime_error("Empty list: " + text);
+    }
+    return values;
+}
+
+template <typename T>
+void CheckChoices(const std::vector<T>& values, std::initializer_list<T> choices, std::string_view option) {
+    for (const auto& value : values) {
+        if (std::find(choices.begin(), choices.end(), value) == choices.end()) {
+            throw std::runtime_error("Unknown " + std::string{option} + ": " + value);
+        }
+    }
+}
+
+[[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
+    po::options_description desc{"All options"s};
+    Args args;
+    std::string methods, layouts, widths, gatherers, items, densities;
+    unsigned min_time_ms = static_cast<unsigned>(args.min_time.count());
+    desc.add_options()
+        ("help,h", "help message")
+        ("methods", po::value(&methods)->value_name("list"s), "find (FindGatherEvents) and/or try (TryCollectPoint for every pair)")
+        ("layouts", po::value(&layouts)->value_name("list"s), "random (short moves over the field) and/or sweep (every gatherer crosses the field)")
+        ("widths", po::value(&widths)->value_name("list"s), "game, uniform and/or outlier width distributions")
+        ("gatherers,g", po::value(&gatherers)->value_name("list"s), "comma separated numbers of gatherers")
+        ("items,i", po::value(&items)->value_name("list"s), "comma separated numbers of items")
+        ("density,d", po::value(&densities)->value_name("list"s), "comma separated numbers of items per square unit")
+        ("step", po::value(&args.step)->value_name("units"s), "move length of the random layout")
+        ("min-time", po::value(&min_time_ms)->value_name("milliseconds"s), "minimal measured time of a case")
+        ("min-repeats", po::value(&args.min_repeats)->value_name("count"s), "minimal number of calls of a case")
+        ("max-try-pairs", po::value(&args.max_try_pairs)->value_name("count"s), "skip brute force cases with more pairs")
+        ("seed", po::value(&args.seed)->value_name("number"s), "random seed of the positions")
+        ("csv", "print a CSV row per case");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+    if (vm.contains("help")) {
+        std::cout << desc;
+        return std::nullopt;
+    }
+    if (vm.contains("methods"s)) {
+        args.methods = ParseList<std::string>(methods);
+    }
+    if (vm.contains("layouts"s)) {
+        args.layouts = ParseList<std::string>(layouts);
+    }
+    if (vm.contains("widths"s)) {
+        args.widths = ParseList<std::string>(widths);
+    }
+    if (vm.contains("gatherers"s)) {
+        args.gatherers = ParseList<size_t>(gatherers);
+    }
+    if (vm.contains("items"s)) {
+        args.items = ParseList<size_t>(items);
+    }
+    if (vm.contains("density"s)) {
+        args.densities = ParseList<double>(densities);
+    }
+    CheckChoices(args.methods, {"find"s, "try"s}, "method"sv);
+    CheckChoices(args.layouts, {"random"s, "sweep"s}, "layout"sv);
+    CheckChoices(args.widths, {"game"s, "uniform"s, "outlier"s}, "widths"sv);
+    for (auto density : args.densities) {
+        if (!(density > 0)) {
+            throw std::runtime_error("Density must be positive");
+        }
+    }
+    if (!(args.step > 0)) {
+        throw std::runtime_error("Step must be positive");
+    }
+    args.min_time = std::chrono::milliseconds{min_time_ms};
+    args.csv = vm.contains("csv"s);
+    return args;
+}
+
+struct Scene {
+    std::vector<cd::Item> items;
+    std::vector<cd::Gatherer> gatherers;
+};
+
+/*
+ * Items are spread uniformly over a square field of items / density square units.
+ * In the random layout gatherers make short moves along the axes like dogs on roads,
+ * in the sweep layout every gatherer crosses the whole field and passes its row of items.
+ */
+Scene MakeScene(const Args& args, const Case& bench_case) {
+    std::mt19937_64 generator{args.seed};
+    const double side = std::sqrt(static_cast<double>(bench_case.items) / bench_case.density);
+    std::uniform_real_distribution<double> coordinate{0, side};
+    std::uniform_real_distribution<double> unit{0, 1};
+
+    auto item_width = [&]() {
+        if (bench_case.widths == "uniform"sv) {
+            return 2 * GATHERER_WIDTH * unit(generator);
+        }
+        if (bench_case.widths == "outlier"sv && unit(generator) < OUTLIER_SHARE) {
+            return OUTLIER_WIDTH;
+        }
+        return ITEM_WIDTH;
+    };
+    auto gatherer_width = [&]() {
+        return bench_case.widths == "uniform"sv ? 2 * GATHERER_WIDTH * unit(generator) : GATHERER_WIDTH;
+    };
+
+    Scene scene;
+    scene.items.reserve(bench_case.items);
+    for (size_t i = 0; i < bench_case.items; ++i) {
+        scene.items.push_back(cd::Item{{coordinate(generator), coordinate(generator)}, item_width()});
+    }
+    scene.gatherers.reserve(bench_case.gatherers);
+    for (size_t i = 0; i < bench_case.gatherers; ++i) {
+        if (bench_case.layout == "sweep"sv) {
+            const double y = coordinate(generator);
+            scene.gatherers.push_back(cd::Gatherer{{0, y}, {side, y}, gatherer_width()});
+            continue;
+        }
+        const geom::Point2D start{coordinate(generator), coordinate(generator)};
+        geom::Point2D end = start;
+        switch (std::uniform_int_distribution<int>{0, 3}(generator)) {
+            case 0: end.x += args.step; break;
+            case 1: end.x -= args.step; break;
+            case 2: end.y += args.step; break;
+            default: end.y -= args.step; break;
+        }
+        scene.gatherers.push_back(cd::Gatherer{start, end, gatherer_width()});
+    }
+    return scene;
+}
+
+// brute force narrowphase over every pair, the baseline of FindGatherEvents
+size_t CollectAllPairs(const Scene& scene) {
+    size_t events = 0;
+    for (const auto& gatherer : scene.gatherers) {
+        for (const auto& item : scene.items) {
+            const auto result = cd::TryCollectPoint(gatherer.start_pos, gatherer.end_pos, item.position);
+            events += result.IsCollected(gatherer.width + item.width);
+        }
+    }
+    return events;
+}
+
+Result Run(const Args& args, const Case& bench_case) {
+    const Scene scene = MakeScene(args, bench_case);
+    cd::GatherScratch scratch;
+    std::vector<cd::GatheringEvent> events;
+
+    auto call = [&]() -> size_t {
+        if (bench_case.method == "try"sv) {
+            return CollectAllPairs(scene);
+        }
+        cd::FindGatherEvents(scene.items, scene.gatherers, scratch, events);
+        return events.size();
+    };
+
+    // the first call warms up the scratch buffers and stays out of the measured time
+    const size_t events_count = call();
+    size_t repeats = 0;
+    size_t sink = 0;
+    std::chrono::duration<double> total {0};
+    while (repeats < args.min_repeats || total < args.min_time) {
+        const auto start = std::chrono::steady_clock::now();
+        sink += call();
+        total += std::chrono::steady_clock::now() - start;
+        ++repeats;
+    }
+    if (sink != events_count * repeats) {
+        throw std::logic_error("Events differ between calls");
+    }
+    return Result{
+        .ns_per_call = std::chrono::duration<double, std::nano>(total).count() / static_cast<double>(repeats),
+        .events = events_count,
+        .repeats = repeats
+    };
+}
+
+// slope of log(ns per call) over log(pairs) by least squares:
+// 1 means the cost grows with every pair, 0.5 means linear in gatherers + items scaled together
+std::optional<double> ScalingExponent(const std::vector<std::pair<Case, Result>>& group) {
+    double sum_x = 0, sum_y = 0, sum_xx = 0, sum_xy = 0;
+    for (const auto& [bench_case, result] : group) {
+        const double x = std::log(static_cast<double>(bench_case.Pairs()));
+        const double y = std::log(result.ns_per_call);
+        sum_x += x;
+        sum_y += y;
+        sum_xx += x * x;
+        sum_xy += x * y;
+    }
+    const double n = static_cast<double>(group.size());
+    const double denominator = n * sum_xx - sum_x * sum_x;
+    if (group.size() < 2 || !(std::abs(denominator) > 1e-12)) {
+        return std::nullopt;
+    }
+    return (n * sum_xy - sum_x * sum_y) / denominator;
+}
+
+void PrintCsvHeader() {
+    std::cout << "method,layout,widths,density,gatherers,items,pairs,repeats,ns_per_call,ns_per_pair,events,exponent\n";
+}
+
+void PrintCsv(const Case& bench_case, const Result& result, std::optional<double> exponent) {
+    std::cout << bench_case.method << ',' << bench_case.layout << ',' << bench_case.widths << ','
+              << bench_case.density << ',' << bench_case.gatherers << ',' << bench_case.items << ','
+              << bench_case.Pairs() << ',' << result.repeats << ','
+              << result.ns_per_call << ',' << result.ns_per_call / static_cast<double>(bench_case.Pairs()) << ','
+              << result.events << ',';
+    if (exponent) {
+        std::cout << *exponent;
+    }
+    std::cout << '\n';
+}
+
+void PrintText(const Case& bench_case, const Result& result) {
+    std::cout << bench_case.method << ", " << bench_case.layout << ", " << bench_case.widths << " widths, density "
+              << bench_case.density << ", gatherers " << bench_case.gatherers << ", items " << bench_case.items << '\n'
+              << "  ns per call: " << result.ns_per_call << '\n'
+              << "  ns per pair: " << result.ns_per_call / static_cast<double>(bench_case.Pairs()) << '\n'
+              << "  events: " << result.events << '\n';
+}
+
+}  // namespace
+
+// Измеряет FindGatherEvents и попарный TryCollectPoint на случайных сценах
+int main(int argc, const char* argv[]) {
+    try {
+        auto args = ParseCommandLine(argc, argv);
+        if (!args) {
+            return EXIT_SUCCESS;
+        }
+        std::cout << std::fixed << std::setprecision(3);
+        if (args->csv) {
+            PrintCsvHeader();
+        }
+        // the sizes of one method, layout, widths and density make a group with one scaling exponent
+        for (const auto& method : args->methods) {
+            for (const auto& layout : args->layouts) {
+                for (const auto& widths : args->widths) {
+                    for (auto density : args->densities) {
+                        std::vector<std::pair<Case, Result>> group;
+                        for (auto gatherers : args->gatherers) {
+                            for (auto items : args->items) {
+                                const Case bench_case{method, layout, widths, density, gatherers, items};
+                                if (bench_case.Pairs() == 0 || (method == "try"sv && bench_case.Pairs() > args->max_try_pairs)) {
+                                    continue;
+                                }
+                                const auto result = Run(*args, bench_case);
+                                group.emplace_back(bench_case, result);
+                                if (!args->csv) {
+                                    PrintText(bench_case, result);
+                                }
+                            }
+                        }
+                        const auto exponent = ScalingExponent(group);
+                        if (args->csv) {
+                            for (const auto& [bench_case, result] : group) {
+                                PrintCsv(bench_case, result, exponent);
+                            }
+                        }
+                        else if (exponent) {
+                            std::cout << method << ", " << layout << ", " << widths << " widths, density " << density
+                                      << ": scaling exponent over pairs " << *exponent << '\n';
+                        }
+                        std::cout << std::flush;
+                    }
+                }
+            }
+        }
+    }
+    catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
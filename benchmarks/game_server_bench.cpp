@@ -0,0 +1,273 @@
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <json_loader.h>
+#include <model/model.h>
+
+using namespace std::literals;
+namespace po = boost::program_options;
+
+namespace {
+
+struct Args {
+    std::optional<std::string> config_file;
+    std::string map_id;
+    std::vector<size_t> dogs {1000};
+    std::vector<size_t> loots {1000};
+    std::vector<int> map_sizes {10};
+    size_t ticks {1000};
+    unsigned tick_ms {50};
+    // scripted dogs pick a new direction every turn_ticks ticks
+    size_t turn_ticks {20};
+    unsigned tick_threads {1};
+    uint64_t seed {1};
+    bool csv {false};
+};
+
+// one point of the sweep
+struct Case {
+    size_t dogs;
+    size_t loots;
+    int map_size;
+};
+
+struct Result {
+    double ticks_per_second;
+    double p50_us;
+    double p99_us;
+    // mean time of a tick spent in every phase of the session
+    std::array<double, model::TICK_PHASE_COUNT> phase_us;
+};
+
+template <typename T>
+std::vector<T> ParseList(const std::string& text) {
+    std::vector<T> values;
+    std::istringstream input{text};
+    std::string item;
+    while (std::getline(input, item, ',')) {
+        values.push_back(static_cast<T>(std::stoll(item)));
+    }
+    if (values.empty()) {
+        throw std::runtime_error("Empty list: " + text);
+    }
+    return values;
+}
+
+[[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
+    po::options_description desc{"All options"s};
+    Args args;
+    std::string config_file, dogs, loots, map_sizes;
+    desc.add_options()
+        ("help,h", "help message")
+        ("config-file,c", po::value(&config_file)->value_name("file"s), "take the map from the game config instead of a synthetic map")
+        ("map-id", po::value(&args.map_id)->value_name("id"s), "map of the config, the first one by default")
+        ("dogs,n", po::value(&dogs)->value_name("list"s), "comma separated numbers of dogs")
+        ("loots,m", po::value(&loots)->value_name("list"s), "comma separated numbers of loots")
+        ("map-size,s", po::value(&map_sizes)->value_name("list"s), "comma separated sizes of the synthetic square map in blocks")
+        ("ticks,k", po::value(&args.ticks)->value_name("count"s), "ticks of every case")
+        ("tick-period", po::value(&args.tick_ms)->value_name("milliseconds"s), "game time of one tick")
+        ("turn-ticks", po::value(&args.turn_ticks)->value_name("count"s), "ticks between turns of a dog")
+        ("tick-threads", po::value(&args.tick_threads)->value_name("count"s), "number of threads ticking the game")
+        ("seed", po::value(&args.seed)->value_name("number"s), "random seed of the game and the dogs")
+        ("csv", "print a CSV row per case");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+    if (vm.contains("help")) {
+        std::cout << desc;
+        return std::nullopt;
+    }
+    if (vm.contains("config-file"s)) {
+        args.config_file = config_file;
+    }
+    if (vm.contains("dogs"s)) {
+        args.dogs = ParseList<size_t>(dogs);
+    }
+    if (vm.contains("loots"s)) {
+        args.loots = ParseList<size_t>(loots);
+    }
+    if (vm.contains("map-size"s)) {
+        args.map_sizes = ParseList<int>(map_sizes);
+    }
+    args.csv = vm.contains("csv"s);
+    if (args.ticks == 0 || args.turn_ticks == 0) {
+        throw std::runtime_error("Ticks must be positive");
+    }
+    return args;
+}
+
+// square grid of roads size x size blocks of 10 units with the offices in the corners
+model::Map MakeSyntheticMap(int size) {
+    constexpr int BLOCK = 10;
+    const int length = size * BLOCK;
+    model::Map map(model::Map::Id{"synthetic"s}, "Synthetic"s);
+    for (int i = 0; i <= size; ++i) {
+        map.AddRoad({model::Road::HORIZONTAL, {0, i * BLOCK}, length});
+        map.AddRoad({model::Road::VERTICAL, {i * BLOCK, 0}, length});
+    }
+    map.AddOffice(model::Office{model::Office::Id{"o1"s}, {0, 0}, {0, 0}});
+    map.AddOffice(model::Office{model::Office::Id{"o2"s}, {length, length}, {0, 0}});
+    map.SetDogSpeed(3.0);
+    map.SetBagCapacity(3);
+    map.AddLootScore(10);
+    map.AddLootScore(20);
+    return map;
+}
+
+model::Game MakeGame(const Args& args, const Case& bench_case, model::Map::Id& map_id) {
+    if (args.config_file) {
+        model::Game game = json_loader::LoadGame(*args.config_file);
+        if (game.GetMaps().empty()) {
+            throw std::runtime_error("No maps in " + *args.config_file);
+        }
+        map_id = args.map_id.empty() ? game.GetMaps().front().GetId() : model::Map::Id{args.map_id};
+        if (game.FindMap(map_id) == nullptr) {
+            throw std::runtime_error("No map " + *map_id);
+        }
+        return game;
+    }
+    model::Game game(model::LootGeneratorConfig{5s, 0.5});
+    game.AddMap(MakeSyntheticMap(bench_case.map_size));
+    map_id = model::Map::Id{"synthetic"s};
+    return game;
+}
+
+double Percentile(const std::vector<double>& sorted, double share) {
+    const auto rank = static_cast<size_t>(share * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+Result Run(const Args& args, const Case& bench_case) {
+    model::Map::Id map_id{""s};
+    auto game = MakeGame(args, bench_case, map_id);
+    game.SetRandomSeed(args.seed);
+    game.SetRandomizeSpawnPoints(true);
+    game.SetTickThreads(args.tick_threads);
+    // the loaded sessions stay for the whole run
+    game.SetSessionEmptyTime(model::TimeDelta{0});
+
+    auto session = game.AddGameSession(map_id);
+    // restored dogs don't bring their own loots, so the session holds exactly the requested loots
+    std::vector<model::Dog::Id> dogs;
+    dogs.reserve(bench_case.dogs);
+    for (size_t i = 0; i < bench_case.dogs; ++i) {
+        auto dog = session->RestoreDog(model::Dog::Id{i}, "dog"s + std::to_string(i), session->GetRandomRoadCoordinate());
+        dogs.push_back(dog->GetId());
+    }
+    model::GameSession::Loots loots;
+    for (size_t i = 0; i < bench_case.loots; ++i) {
+        loots.push_back(model::Loot{.id = session->GetNextLootId(), .type = 0, .coordinate = session->GetRandomRoadCoordinate()});
+    }
+    session->SetLoots(loots);
+
+    model::RandomEngine script{args.seed};
+    constexpr model::DOG_MOVE MOVES[] = {model::DOG_MOVE::LEFT, model::DOG_MOVE::RIGHT, model::DOG_MOVE::UP, model::DOG_MOVE::DOWN};
+    const model::TimeDelta tick_time = std::chrono::milliseconds{args.tick_ms};
+
+    std::vector<double> tick_us;
+    tick_us.reserve(args.ticks);
+    std::array<double, model::TICK_PHASE_COUNT> phase_us {};
+    std::chrono::duration<double> total {0};
+    for (size_t tick = 0; tick < args.ticks; ++tick) {
+        // the turns are spread over the ticks and stay out of the measured time
+        for (size_t i = (tick % args.turn_ticks); i < dogs.size(); i += args.turn_ticks) {
+            session->MoveDog(dogs[i], MOVES[script.NextIndex(std::size(MOVES))]);
+        }
+        const auto start = std::chrono::steady_clock::now();
+        game.Tick(tick_time);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        total += elapsed;
+        tick_us.push_back(elapsed.count() * 1e6);
+        const auto& phases = session->GetLastTickTimes();
+        for (size_t phase = 0; phase < model::TICK_PHASE_COUNT; ++phase) {
+            phase_us[phase] += std::chrono::duration<double, std::micro>(phases.phases[phase]).count();
+        }
+    }
+
+    std::sort(tick_us.begin(), tick_us.end());
+    Result result {
+        .ticks_per_second = static_cast<double>(args.ticks) / total.count(),
+        .p50_us = Percentile(tick_us, 0.5),
+        .p99_us = Percentile(tick_us, 0.99),
+        .phase_us = phase_us
+    };
+    for (auto& phase : result.phase_us) {
+        phase /= static_cast<double>(args.ticks);
+    }
+    return result;
+}
+
+void PrintCsvHeader() {
+    std::cout << "map,map_size,dogs,loots,ticks,ticks_per_second,p50_us,p99_us";
+    for (auto name : model::TICK_PHASE_NAMES) {
+        std::cout << ',' << name << "_us";
+    }
+    std::cout << '\n';
+}
+
+void PrintCsv(const Args& args, const Case& bench_case, const Result& result) {
+    std::cout << (args.config_file ? (args.map_id.empty() ? "config"s : args.map_id) : "synthetic"s) << ','
+              << (args.config_file ? 0 : bench_case.map_size) << ','
+              << bench_case.dogs << ',' << bench_case.loots << ',' << args.ticks << ','
+              << result.ticks_per_second << ',' << result.p50_us << ',' << result.p99_us;
+    for (auto phase : result.phase_us) {
+        std::cout << ',' << phase;
+    }
+    std::cout << std::endl;
+}
+
+void PrintText(const Case& bench_case, const Result& result) {
+    std::cout << "dogs " << bench_case.dogs << ", loots " << bench_case.loots << ", map size " << bench_case.map_size << '\n'
+              << "  ticks per second: " << result.ticks_per_second << '\n'
+              << "  tick p50, us: " << result.p50_us << '\n'
+              << "  tick p99, us: " << result.p99_us << '\n';
+    for (size_t phase = 0; phase < model::TICK_PHASE_COUNT; ++phase) {
+        std::cout << "  " << model::TICK_PHASE_NAMES[phase] << ", us: " << result.phase_us[phase] << '\n';
+    }
+    std::cout << std::flush;
+}
+
+}  // namespace
+
+// Измеряет стоимость Game::Tick на синтетической карте или карте из конфигурации
+int main(int argc, const char* argv[]) {
+    try {
+        auto args = ParseCommandLine(argc, argv);
+        if (!args) {
+            return EXIT_SUCCESS;
+        }
+        std::cout << std::fixed << std::setprecision(3);
+        if (args->csv) {
+            PrintCsvHeader();
+        }
+        // the size of a config map is fixed
+        const auto map_sizes = args->config_file ? std::vector<int>{0} : args->map_sizes;
+        for (auto map_size : map_sizes) {
+            for (auto dogs : args->dogs) {
+                for (auto loots : args->loots) {
+                    const Case bench_case{dogs, loots, map_size};
+                    const auto result = Run(*args, bench_case);
+                    if (args->csv) {
+                        PrintCsv(*args, bench_case, result);
+                    }
+                    else {
+                        PrintText(bench_case, result);
+                    }
+                }
+            }
+        }
+    }
+    catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
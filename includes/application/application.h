@@ -14,6 +14,10 @@
 #include <gameplay.h>
 #include <database/postgres.h>
 #include <chrono>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <functional>
 
 namespace application {
 
@@ -35,22 +39,64 @@ enum APPLICATION_ERROR {
 std::optional<std::string> check_token(const std::string& authorization_text);
 std::string SerializeMessageCode(const std::string& code, const std::string& message);
 
+/*
+ *  Неизменяемое состояние игры, опубликованное потоком симуляции для запросов на чтение.
+ *  Ответы GetState и GetPlayers сериализуются один раз при изменении и разделяются всеми
+ *  читателями, поэтому чтение идёт в любом потоке io без перехода в strand и без копирования.
+ */
+struct PublishedState {
+    using Text = std::shared_ptr<const std::string>;
+
+    struct PlayerEntry {
+        // a reclaimed session's address may be reused by a new one, the id never is
+        uint64_t session_id;
+        model::Dog::Id dog_id;
+        // actions of the player go to the session without the simulation thread
+        std::shared_ptr<model::GameSession::MoveQueue> moves;
+    };
+    using TokenToPlayer = std::unordered_map<gameplay::Token, PlayerEntry, util::TaggedHasher<gameplay::Token>>;
+
+    struct SessionState {
+        uint64_t version;
+        Text state;
+    };
+    // by GameSession::GetId
+    using Sessions = std::unordered_map<uint64_t, SessionState>;
+
+    // the player of the token, the joined players are checked after the published ones
+    const PlayerEntry* FindPlayer(const gameplay::Token& token) const;
+
+    // rebuilt only when the players change
+    std::shared_ptr<const TokenToPlayer> token_to_player;
+    // players joined after token_to_player was built, the next publication folds them in
+    std::shared_ptr<const TokenToPlayer> joined;
+    Text players;
+    std::shared_ptr<const Sessions> sessions;
+};
+
 class Application
 {
 public:
+    using AdvanceTime = std::function<void(model::TimeDelta delta)>;
+
     explicit Application(model::Game& game, size_t threads_count, const std::string& database_url) : 
         game_{ game },
         database_{ threads_count, database_url } {}
 
     std::string GetMapJson(const std::string& request_target, http::status& response_status);
     std::string Join(const std::string& jsonBody, APPLICATION_ERROR& join_error);
+    // GetPlayers and GetState read the published state and may run in any thread
     std::string GetPlayers(const std::string& auth_message, APPLICATION_ERROR& auth_error);
     std::string GetState(const std::string& auth_message, APPLICATION_ERROR& app_error);
+    // applies the action at once and publishes it, used with the tick API in the simulation thread
     std::string ActionPlayer(const std::string& auth_message, APPLICATION_ERROR& app_error, const std::string& jsonBody);
-    std::string Tick(const std::string& jsonBody, APPLICATION_ERROR& app_error);
+    // puts the action to the session's queue, it is applied by the next tick; may run in any thread
+    std::string QueueActionPlayer(const std::string& auth_message, APPLICATION_ERROR& app_error, const std::string& jsonBody);
+    // advance_time runs the game for the requested time together with the other scheduled tasks
+    std::string Tick(const std::string& jsonBody, APPLICATION_ERROR& app_error, const AdvanceTime& advance_time);
     gameplay::Player* GetPlayerFromToken(const std::string& auth_message, APPLICATION_ERROR& app_error, std::string& app_error_msg);
     boost::json::array GetDogLoots(const model::Dog& dog);
-    void RetirePlayers(std::chrono::milliseconds delta);
+    void RetirePlayers(model::TimeDelta delta);
     std::string GetRecords(unsigned start, unsigned max_items, APPLICATION_ERROR& app_error);
     
     model::Game& GetGameModel() {
@@ -73,13 +119,33 @@ public:
         return last_player_id_;
     }
 
+    /*
+     * Публикует состояние для читателей. Вызывается в потоке симуляции задачей планировщика после тика,
+     * сессии с прежней версией переиспользуют уже сериализованный ответ. Вошедший между публикациями
+     * игрок сразу добавляется к опубликованному состоянию вместе со своей сессией и списком имён,
+     * остальные сессии и таблица токенов не пересобираются.
+     */
+    void PublishState();
+
+    // the players have been restored or changed outside Join and RetirePlayers
+    void MarkPlayersChanged() noexcept {
+        players_changed_ = true;
+    }
+
 private:
+    std::string SerializeSessionState(const model::GameSession& session);
+    std::string SerializePlayers();
+    static PublishedState::PlayerEntry MakePlayerEntry(gameplay::Player& player);
+    // makes the token, the dog and the name of the joined player visible to the readers before the next publication
+    void PublishJoin(const gameplay::Token& token, gameplay::Player& player);
+
     model::Game& game_;
     gameplay::Players players_;
     gameplay::PlayerTokens player_tokens_;
     gameplay::Player::Id last_player_id_{0};
     postgres::Database database_;
-
+    bool players_changed_ {true};
+    std::atomic<std::shared_ptr<const PublishedState>> published_state_;
 
     gameplay::Player* GetPlayer(const std::string& name, const std::string& mapId);
 };
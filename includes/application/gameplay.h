@@ -57,6 +57,9 @@ private:
 };
 
 
+// move of the dog for the command of the action request: "L", "R", "U", "D" or "" to stop
+model::DOG_MOVE ParseMove(const std::string& command);
+
 class Player {
 public:
     using Id = util::Tagged<uint64_t, Player>;
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace model {
+
+/*
+ *  Очередь команд игроков одной игровой сессии без блокировок.
+ *  Команды добавляются из любых потоков в односвязный стек с атомарной вершиной,
+ *  единственный читатель - тик сессии - забирает весь стек одной атомарной операцией,
+ *  поэтому проблемы ABA не возникает.
+ */
+template <typename Action>
+class ActionQueue {
+    struct Node {
+        Action action;
+        Node* next;
+    };
+
+public:
+    ActionQueue() = default;
+
+    ~ActionQueue() {
+        Free(head_.exchange(nullptr, std::memory_order_acquire));
+    }
+
+    ActionQueue(const ActionQueue&) = delete;
+    ActionQueue& operator=(const ActionQueue&) = delete;
+
+    // may be called from any thread
+    void Push(const Action& action) {
+        auto node = new Node{action, head_.load(std::memory_order_relaxed)};
+        while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    bool Empty() const noexcept {
+        return head_.load(std::memory_order_acquire) == nullptr;
+    }
+
+    // moves the queued actions to actions, the newest one first; only one thread may drain the queue
+    void Drain(std::vector<Action>& actions) {
+        actions.clear();
+        auto node = head_.exchange(nullptr, std::memory_order_acquire);
+        try {
+            while (node != nullptr) {
+                actions.push_back(node->action);
+                delete std::exchange(node, node->next);
+            }
+        }
+        catch (...) {
+            Free(node);
+            throw;
+        }
+    }
+
+private:
+    static void Free(Node* node) noexcept {
+        while (node != nullptr) {
+            delete std::exchange(node, node->next);
+        }
+    }
+
+    std::atomic<Node*> head_ {nullptr};
+};
+
+}  // namespace model
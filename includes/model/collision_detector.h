@@ -3,6 +3,10 @@
 #include "geom.h"
 
 #include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <memory>
+#include <span>
 #include <vector>
 
 namespace collision_detector {
@@ -23,6 +27,20 @@ struct CollectionResult {
 // Эта функция реализована в уроке.
 CollectionResult TryCollectPoint(geom::Point2D a, geom::Point2D b, geom::Point2D c);
 
+// Попадание пакетной проверки: индекс точки в блоке и результат TryCollectPoint для неё.
+struct CollectHit {
+    size_t index;
+    double sq_distance;
+    double proj_ratio;
+};
+
+// Движемся из точки a в точку b и пытаемся подобрать точки блока (xs[i], ys[i]) радиуса widths[i].
+// Результат каждой точки совпадает с TryCollectPoint, попадания дописываются в hits по возрастанию индекса.
+// На процессорах с AVX2 обрабатывается по 4 точки за инструкцию.
+void CollectPoints(geom::Point2D a, geom::Point2D b, double gatherer_width,
+                   const double* xs, const double* ys, const double* widths, size_t count,
+                   std::vector<CollectHit>& hits);
+
 struct Item {
     geom::Point2D position;
     double width;
@@ -34,6 +52,26 @@ struct Gatherer {
     double width;
 };
 
+/*
+ *  Источник предметов и собирателей, проверяемый во время компиляции.
+ *  FindGatherEvents для такого источника - шаблон, поэтому вызовы GetItem/GetGatherer встраиваются.
+ *  Если источник хранит предметы и собирателей непрерывно (GetItems/GetGatherers), они не копируются.
+ */
+template <typename Provider>
+concept ItemGathererSource = requires(const Provider& provider, size_t idx) {
+    { provider.ItemsCount() } -> std::convertible_to<size_t>;
+    { provider.GetItem(idx) } -> std::convertible_to<Item>;
+    { provider.GatherersCount() } -> std::convertible_to<size_t>;
+    { provider.GetGatherer(idx) } -> std::convertible_to<Gatherer>;
+};
+
+template <typename Provider>
+concept ContiguousItemGathererSource = ItemGathererSource<Provider> && requires(const Provider& provider) {
+    { provider.GetItems() } -> std::convertible_to<std::span<const Item>>;
+    { provider.GetGatherers() } -> std::convertible_to<std::span<const Gatherer>>;
+};
+
+// Интерфейс источника с виртуальными функциями, оставлен для совместимости.
 class ItemGathererProvider {
 protected:
     ~ItemGathererProvider() = default;
@@ -52,7 +90,7 @@ struct GatheringEvent {
     double time;
 };
 
-class ItemGatherer : public ItemGathererProvider {
+class ItemGatherer final : public ItemGathererProvider {
 public:
     using Items = std::vector<Item>;
     using Gatherers = std::vector<Gatherer>;
@@ -81,14 +119,74 @@ public:
     virtual Gatherer GetGatherer(size_t idx) const override {
         return gatherers_[idx];
     }
+    // keeps the capacity, so refilling doesn't allocate
+    void Clear() noexcept {
+        items_.clear();
+        gatherers_.clear();
+    }
+    const Items& GetItems() const noexcept {
+        return items_;
+    }
+    const Gatherers& GetGatherers() const noexcept {
+        return gatherers_;
+    }
 
 private:
     Items items_;
     Gatherers gatherers_;
 };
 
-// Эту функцию вам нужно будет реализовать в соответствующем задании.
-// При проверке ваших тестов она не нужна - функция будет линковаться снаружи.
+// Буферы FindGatherEvents, переиспользуемые между вызовами:
+// после прогрева поиск событий не выделяет память.
+class GatherScratch {
+public:
+    GatherScratch();
+    ~GatherScratch();
+    GatherScratch(GatherScratch&&) noexcept;
+    GatherScratch& operator=(GatherScratch&&) noexcept;
+
+    // time the last FindGatherEvents spent on its broadphase: the grid or the block of items
+    std::chrono::steady_clock::duration GetBroadphaseTime() const noexcept;
+
+private:
+    friend void FindGatherEvents(std::span<const Item>, std::span<const Gatherer>,
+                                 GatherScratch&, std::vector<GatheringEvent>&);
+    struct Buffers;
+    std::unique_ptr<Buffers> buffers_;
+};
+
+// Упорядочивает события по времени, равные по времени - по сборщику и предмету,
+// поэтому порядок не зависит от того, в каком порядке события были найдены.
+void SortGatherEvents(std::vector<GatheringEvent>& gather_events);
+
+// Заполняет gather_events событиями сбора, отсортированными по времени.
+void FindGatherEvents(std::span<const Item> items, std::span<const Gatherer> gatherers,
+                      GatherScratch& scratch, std::vector<GatheringEvent>& gather_events);
+
+// События сбора, отсортированные по времени.
+std::vector<GatheringEvent> FindGatherEvents(std::span<const Item> items, std::span<const Gatherer> gatherers);
+
+template <ItemGathererSource Provider>
+std::vector<GatheringEvent> FindGatherEvents(const Provider& provider) {
+    if constexpr (ContiguousItemGathererSource<Provider>) {
+        return FindGatherEvents(std::span<const Item>(provider.GetItems()), std::span<const Gatherer>(provider.GetGatherers()));
+    }
+    else {
+        std::vector<Item> items;
+        items.reserve(provider.ItemsCount());
+        for (size_t idx = 0; idx < provider.ItemsCount(); ++idx) {
+            items.push_back(provider.GetItem(idx));
+        }
+        std::vector<Gatherer> gatherers;
+        gatherers.reserve(provider.GatherersCount());
+        for (size_t idx = 0; idx < provider.GatherersCount(); ++idx) {
+            gatherers.push_back(provider.GetGatherer(idx));
+        }
+        return FindGatherEvents(items, gatherers);
+    }
+}
+
+// Тонкий адаптер для источников с виртуальным интерфейсом.
 std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider);
 
 }  // namespace collision_detector
\ No newline at end of file
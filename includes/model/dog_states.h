@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <game_time.h>
+
+namespace model {
+
+/*
+ *  Горячее состояние собак игровой сессии в виде структуры массивов.
+ *  Координаты и скорости лежат в непрерывных массивах, движущиеся собаки перечислены
+ *  в активном множестве, поэтому шаг интегрирования в GameSession::Tick не трогает стоящих собак.
+ *  Время жизни и время простоя не накапливаются каждый тик, а вычисляются по часам сессии.
+ *  Имя, рюкзак и прочие редко используемые данные остаются в объектах Dog.
+ */
+struct DogStates {
+    static constexpr uint32_t NOT_ACTIVE = std::numeric_limits<uint32_t>::max();
+
+    // occupies the slot, appending it when slot == Size()
+    void Place(size_t slot, double pos_x, double pos_y);
+
+    // keeps only the first size slots
+    void Truncate(size_t size);
+
+    size_t Size() const noexcept {
+        return x.size();
+    }
+
+    bool IsStanding(size_t slot) const noexcept {
+        return active_index[slot] == NOT_ACTIVE;
+    }
+
+    void MoveTo(size_t slot, double pos_x, double pos_y) noexcept {
+        prev_x[slot] = x[slot];
+        prev_y[slot] = y[slot];
+        x[slot] = pos_x;
+        y[slot] = pos_y;
+    }
+
+    // keeps the active set in sync with the speed, a stopped dog starts its stay time now
+    void SetSpeed(size_t slot, double vel_x, double vel_y) noexcept;
+
+    void Stop(size_t slot) noexcept {
+        SetSpeed(slot, 0, 0);
+    }
+
+    // time since the dog joined the session
+    TimeDelta Lifetime(size_t slot) const noexcept {
+        return time - join_time[slot];
+    }
+
+    // time since the dog stopped, 0 for a moving dog
+    TimeDelta StayTime(size_t slot) const noexcept {
+        return IsStanding(slot) ? Lifetime(slot) - last_move_time[slot] : TimeDelta{0};
+    }
+
+    void SetLifetime(size_t slot, TimeDelta lifetime) noexcept {
+        join_time[slot] = time - lifetime;
+    }
+
+    /*
+     * Продвигает часы сессии на move_time и интегрирует движение активных собак:
+     * заполняет end_x/end_y.
+     */
+    void Integrate(TimeDelta move_time);
+
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> prev_x;
+    std::vector<double> prev_y;
+    std::vector<double> speed_x;
+    std::vector<double> speed_y;
+    // time of the session clock
+    std::vector<TimeDelta> join_time;
+    // lifetime of the dog when it stopped
+    std::vector<TimeDelta> last_move_time;
+
+    // end positions computed by Integrate for the active slots
+    std::vector<double> end_x;
+    std::vector<double> end_y;
+
+    // slots of the moving dogs and the position of every slot in active or NOT_ACTIVE
+    std::vector<uint32_t> active;
+    std::vector<uint32_t> active_index;
+
+    // session clock
+    TimeDelta time {0};
+};
+
+}  // namespace model
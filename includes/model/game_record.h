@@ -0,0 +1,129 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <model.h>
+
+namespace model {
+
+/*
+ *  Журнал операций над моделью игры для воспроизведения реальной нагрузки.
+ *  Записываются открытие сессий, вход, движение и удаление собак и шаги времени в том порядке,
+ *  в каком они применялись к Game. Генераторы случайных чисел сессий зависят только от зерна
+ *  из заголовка, поэтому повтор журнала на той же конфигурации даёт то же состояние игры.
+ *  Собаки в журнале нумеруются по порядку входа: идентификаторы собак общие для процесса.
+ */
+enum class RecordEventType : uint8_t {
+    NEW_SESSION = 1,
+    JOIN,
+    MOVE,
+    LEAVE,
+    TICK
+};
+
+struct RecordHeader {
+    static constexpr char MAGIC[4] = {'D', 'S', 'R', 'C'};
+    static constexpr uint32_t VERSION = 1;
+
+    uint64_t random_seed {0};
+    bool randomize_spawn_points {false};
+};
+
+struct RecordEvent {
+    RecordEventType type {RecordEventType::TICK};
+    // map id of NEW_SESSION, dog name of JOIN
+    std::string text;
+    // serial number of the session in the order of NEW_SESSION
+    uint32_t session {0};
+    // number of the dog in the order of JOIN
+    uint32_t dog {0};
+    DOG_MOVE move {DOG_MOVE::STAND};
+    TimeDelta delta {0};
+};
+
+// writes the operations applied to the game, called in the simulation thread only
+class GameRecorder {
+public:
+    explicit GameRecorder(std::ostream& output)
+        : output_{output} {
+    }
+
+    void WriteHeader(const RecordHeader& header);
+
+    // returns the serial number of the session
+    uint32_t RecordNewSession(const Map::Id& map_id);
+    void RecordJoin(uint32_t session, const Dog::Id& dog_id, const std::string& name);
+    void RecordMove(const Dog::Id& dog_id, DOG_MOVE move);
+    void RecordLeave(const Dog::Id& dog_id);
+    void RecordTick(TimeDelta delta);
+
+    void Flush() {
+        output_.flush();
+    }
+
+private:
+    using DogIdHasher = util::TaggedHasher<Dog::Id>;
+
+    uint32_t DogNumber(const Dog::Id& dog_id) const;
+
+    std::ostream& output_;
+    uint32_t sessions_ {0};
+    uint32_t next_dog_ {0};
+    std::unordered_map<Dog::Id, uint32_t, DogIdHasher> dog_numbers_;
+};
+
+class GameRecordReader {
+public:
+    explicit GameRecordReader(std::istream& input)
+        : input_{input} {
+    }
+
+    // throws std::runtime_error if the input is not a record of a supported version
+    RecordHeader ReadHeader();
+
+    // false at the end of the record, throws std::runtime_error on a truncated event
+    bool Next(RecordEvent& event);
+
+private:
+    std::istream& input_;
+};
+
+/*
+ *  Применяет события журнала к Game без сети и базы данных.
+ *  Game должна быть загружена из той же конфигурации и ещё не иметь сессий.
+ */
+class GameReplay {
+public:
+    GameReplay(Game& game, const RecordHeader& header);
+
+    void Apply(const RecordEvent& event);
+
+    uint64_t GetTicks() const noexcept {
+        return ticks_;
+    }
+
+    TimeDelta GetGameTime() const noexcept {
+        return game_time_;
+    }
+
+private:
+    struct DogRef {
+        GameSession* session;
+        Dog::Id dog_id;
+    };
+
+    GameSession* FindSession(uint32_t session) const;
+    const DogRef& FindDog(uint32_t dog) const;
+
+    Game& game_;
+    std::vector<GameSession*> sessions_;
+    std::vector<DogRef> dogs_;
+    uint64_t ticks_ {0};
+    TimeDelta game_time_ {0};
+};
+
+}  // namespace model
@@ -0,0 +1,14 @@
+#pragma once
+#include <chrono>
+
+namespace model {
+
+// Шаг времени модели. Микросекунды не теряют время на округлении даже при тиках в 1-2 мс
+using TimeDelta = std::chrono::microseconds;
+
+// seconds as a double for the integration of speeds
+inline double ToSeconds(TimeDelta time) noexcept {
+    return std::chrono::duration<double>(time).count();
+}
+
+}  // namespace model
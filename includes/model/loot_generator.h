@@ -10,7 +10,7 @@ namespace loot_gen {
 class LootGenerator {
 public:
     using RandomGenerator = std::function<double()>;
-    using TimeInterval = std::chrono::milliseconds;
+    using TimeInterval = std::chrono::microseconds;
 
     /*
      * base_interval - базовый отрезок времени > 0
@@ -35,6 +35,14 @@ public:
      */
     unsigned Generate(TimeInterval time_delta, unsigned loot_count, unsigned looter_count);
 
+    /*
+     * Учитывает время, когда трофеи не могли появиться: трофеев на карте не меньше, чем мародёров.
+     * Эквивалентно Generate без обращения к генератору случайных чисел.
+     */
+    void Skip(TimeInterval time_delta) noexcept {
+        time_without_loot_ += time_delta;
+    }
+
 private:
     static double DefaultGenerator() noexcept {
         return 1.0;
@@ -1,5 +1,4 @@
 #pragma once
-#include <boost/signals2.hpp>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -8,15 +7,30 @@
 #include <map>
 #include <memory>
 #include <list>
-#include <random>
+#include <optional>
+#include <limits>
+#include <iterator>
+#include <functional>
+#include <utility>
 
 #include <tagged.h>
+#include <game_time.h>
+#include <tick_profile.h>
 #include <loot_generator.h>
 #include <extra_data.h>
+#include <road_index.h>
+#include <road_sampler.h>
+#include <random_engine.h>
+#include <dog_states.h>
+#include <tick_executor.h>
+#include <slot_map.h>
+#include <collision_detector.h>
+#include <action_queue.h>
 
 namespace model {
 
 class GameSession;
+class GameRecorder;
 
 using Dimension = int;
 using Coord = Dimension;
@@ -160,6 +174,24 @@ public:
         roads_.emplace_back(road);
     }
 
+    // builds the road index shared by every game session of the map
+    void BuildRoadIndex() {
+        road_index_ = std::make_shared<const RoadIndex>(roads_);
+    }
+
+    const RoadIndex& GetRoadIndex() const noexcept {
+        return *road_index_;
+    }
+
+    // builds the length-weighted spawn sampler shared by every game session of the map
+    void BuildRoadSampler() {
+        road_sampler_ = std::make_shared<const RoadSampler>(roads_);
+    }
+
+    const RoadSampler& GetRoadSampler() const noexcept {
+        return *road_sampler_;
+    }
+
     void AddBuilding(const Building& building) {
         buildings_.emplace_back(building);
     }
@@ -182,6 +214,15 @@ public:
         return bag_capacity_;
     } 
 
+    // 0 - unlimited
+    void SetSessionMaxPlayers(size_t max_players) {
+        session_max_players_ = max_players;
+    }
+
+    size_t GetSessionMaxPlayers() const {
+        return session_max_players_;
+    }
+
     void AddLootScore(int loot_score) {
         loot_scores_.push_back(loot_score);
     }
@@ -200,9 +241,12 @@ private:
     Id id_;
     std::string name_;
     Roads roads_;
+    std::shared_ptr<const RoadIndex> road_index_;
+    std::shared_ptr<const RoadSampler> road_sampler_;
     Buildings buildings_;
     double dog_speed_;
     int bag_capacity_;
+    size_t session_max_players_ {0};
 
     OfficeIdToIndex warehouse_id_to_index_;
     Offices offices_;
@@ -215,125 +259,176 @@ public:
     double probability {0.5};
 };
 
-class Game {
+class DogCoordinate {
 public:
-    Game(const LootGeneratorConfig& loot_generator_config) : loot_generator_config_(std::move(loot_generator_config)) {}
+    double x{0};
+    double y{0};
 
-    using Maps = std::vector<Map>;
+    bool operator==(const DogCoordinate& dog) const {
+        if (x == dog.x && y == dog.y) {
+            return true;
+        }
+        else {
+            return false;
+        }
+    }
 
-    using GameSessions = std::deque<GameSession>;
+    bool operator!=(const DogCoordinate& dog) const {
+        if (x != dog.x || y != dog.y) {
+            return true;
+        }
+        else {
+            return false;
+        }        
+    }
+};
 
-    void AddMap(const Map& map);
+class Loot {
+public:
+    using Id = util::Tagged<uint32_t, Loot>;
 
-    const Maps& GetMaps() const noexcept {
-        return maps_;
-    }
+    Id id{0};
+    int type {0};
+    DogCoordinate coordinate;
+};
 
-    void SetDefaultDogSpeed(double speed) {
-        DefaultDogSpeed = speed;
-    }
+/*
+ *  Пул трофеев игровой сессии.
+ *  Трофеи лежат в непрерывном массиве и адресуются небольшими целыми дескрипторами,
+ *  освободившиеся ячейки используются повторно. Трофеи на карте перечислены в плотном массиве
+ *  дескрипторов, рюкзаки собак хранят дескрипторы, поэтому появление, подбор и сдача трофея
+ *  не выделяют память, когда пул уже прогрет.
+ */
+class LootPool {
+    struct Entry {
+        Loot loot;
+        // position in on_map_ or NOT_ON_MAP
+        uint32_t map_position;
+    };
 
-    void SetDefaultBagCapacity(int bag_capacity) {
-        DefaultBagCapacity = bag_capacity;
-    }
+public:
+    using Handle = uint32_t;
+    using Handles = std::vector<Handle>;
+
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Loot;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Loot*;
+        using reference = const Loot&;
+
+        Iterator() = default;
+        Iterator(const LootPool* pool, Handles::const_iterator it) : pool_(pool), it_(it) {}
+
+        reference operator*() const {
+            return pool_->Get(*it_);
+        }
 
-    const Map* FindMap(const Map::Id& id) const noexcept;
+        pointer operator->() const {
+            return &pool_->Get(*it_);
+        }
 
-    GameSession* FindGameSession(const Map::Id& id) noexcept;
+        Iterator& operator++() {
+            ++it_;
+            return *this;
+        }
 
-    GameSession* AddGameSession(const Map::Id& id);
+        Iterator operator++(int) {
+            auto copy = *this;
+            ++it_;
+            return copy;
+        }
 
-    void Tick(uint64_t time_delta);
+        bool operator==(const Iterator& other) const {
+            return it_ == other.it_;
+        }
 
-    void SetRandomizeSpawnPoints(bool randomize_spawn_points) {
-        randomize_spawn_points_ = randomize_spawn_points;
-    }
+    private:
+        const LootPool* pool_ {nullptr};
+        Handles::const_iterator it_;
+    };
 
-    bool IsRandomizeSpawnPoints() {
-        return randomize_spawn_points_;
+    // allocates the loot and puts it on the map
+    Handle Spawn(const Loot& loot) {
+        auto handle = Store(loot);
+        try {
+            on_map_.push_back(handle);
+        }
+        catch (...) {
+            Release(handle);
+            throw;
+        }
+        entries_[handle].map_position = static_cast<uint32_t>(on_map_.size() - 1);
+        return handle;
     }
 
-    std::string GetLootType(const Map::Id& id) {
-        return loot_type_.GetLootType(*id);
+    // allocates the loot without putting it on the map, e.g. for a restored bag
+    Handle Store(const Loot& loot) {
+        if (free_.empty()) {
+            entries_.push_back(Entry{loot, NOT_ON_MAP});
+            try {
+                // Release never allocates: the free list can hold every entry
+                free_.reserve(entries_.capacity());
+            }
+            catch (...) {
+                entries_.pop_back();
+                throw;
+            }
+            return static_cast<Handle>(entries_.size() - 1);
+        }
+        auto handle = free_.back();
+        free_.pop_back();
+        entries_[handle] = Entry{loot, NOT_ON_MAP};
+        return handle;
     }
 
-    void AddLootType(const extra_data::LootType& loot_type) {
-        loot_type_ = std::move(loot_type);
+    // takes the loot from the map, it stays allocated for the bag
+    void PickUp(Handle handle) noexcept {
+        auto position = entries_[handle].map_position;
+        auto last = on_map_.back();
+        on_map_[position] = last;
+        entries_[last].map_position = position;
+        on_map_.pop_back();
+        entries_[handle].map_position = NOT_ON_MAP;
     }
 
-    GameSessions& GetGameSessions() {
-        return game_sessions_;
+    // frees the loot taken off the map
+    void Release(Handle handle) noexcept {
+        free_.push_back(handle);
     }
 
-    void SetGameSessions(const GameSessions& game_sessions);
-
-    const LootGeneratorConfig& GetLootGeneratorConfig() const {
-        return loot_generator_config_;
+    bool IsOnMap(Handle handle) const noexcept {
+        return entries_[handle].map_position != NOT_ON_MAP;
     }
 
-    // Добавляем обработчик сигнала tick и возвращаем объект connection для управления,
-    // при помощи которого можно отписаться от сигнала
-    [[nodiscard]] boost::signals2::connection DoOnTickSlot(const boost::signals2::signal<void(std::chrono::milliseconds delta)>::slot_type& handler) {
-        return tick_signal_.connect(handler);
+    const Loot& Get(Handle handle) const noexcept {
+        return entries_[handle].loot;
     }
 
-    void SetRetirementTime(double retirement_time) {
-        retirement_time_ = std::chrono::milliseconds(static_cast<size_t>(retirement_time));
+    // handles of the loots lying on the map
+    const Handles& OnMap() const noexcept {
+        return on_map_;
     }
 
-    std::chrono::milliseconds GetRetirementTime() const {
-        return retirement_time_;
+    size_t Size() const noexcept {
+        return on_map_.size();
     }
 
-private:
-    using MapIdHasher = util::TaggedHasher<Map::Id>;
-    using MapIdToIndex = std::unordered_map<Map::Id, size_t, MapIdHasher>;
-     
-    Maps maps_;
-    double DefaultDogSpeed {0.0};
-    int DefaultBagCapacity {0};
-    GameSessions game_sessions_;
-    MapIdToIndex map_id_to_index_;
-    MapIdToIndex map_id_to_game_sessions_index_;
-    bool randomize_spawn_points_ {false};
-    LootGeneratorConfig loot_generator_config_;
-    extra_data::LootType loot_type_;
-    boost::signals2::signal<void(std::chrono::milliseconds delta)> tick_signal_;
-    std::chrono::milliseconds retirement_time_{0};
-};
-
-
-class DogCoordinate {
-public:
-    double x{0};
-    double y{0};
-
-    bool operator==(const DogCoordinate& dog) const {
-        if (x == dog.x && y == dog.y) {
-            return true;
-        }
-        else {
-            return false;
-        }
+    Iterator begin() const {
+        return Iterator(this, on_map_.begin());
     }
 
-    bool operator!=(const DogCoordinate& dog) const {
-        if (x != dog.x || y != dog.y) {
-            return true;
-        }
-        else {
-            return false;
-        }        
+    Iterator end() const {
+        return Iterator(this, on_map_.end());
     }
-};
 
-class Loot {
-public:
-    using Id = util::Tagged<uint32_t, Loot>;
+private:
+    static constexpr uint32_t NOT_ON_MAP = std::numeric_limits<uint32_t>::max();
 
-    Id id{0};
-    int type {0};
-    DogCoordinate coordinate;
+    std::vector<Entry> entries_;
+    Handles free_;
+    Handles on_map_;
 };
 
 class DogSpeed {
@@ -394,66 +489,97 @@ private:
 class Dog {
 public:
     using Id = util::Tagged<size_t, Dog>;
+
+    using Bag = LootPool::Handles;
+
+    // dog's hot state lives in the slot of session's DogStates, loots of the bag live in session's LootPool
     Dog(
         const std::string& dog_name,
-        const DogCoordinate& dog_coordinate
+        DogStates& states,
+        size_t slot,
+        LootPool& loot_pool
     ) : 
-        dog_name_(dog_name), 
         id_(Id{ DOG_INDEX() }),  
-        dog_coordinate_(dog_coordinate) {}
+        dog_name_(dog_name), 
+        states_(&states),
+        slot_(slot),
+        loot_pool_(&loot_pool) {}
+
+    Dog(const std::string& name, Id id, DogStates& states, size_t slot, LootPool& loot_pool) :
+        id_(id),
+        dog_name_(name), 
+        states_(&states),
+        slot_(slot),
+        loot_pool_(&loot_pool) {UPDATE_DOG_INDEX(*id);}
     
-    const Id& GetId() {
+    const Id& GetId() const {
         return id_;
     }
 
-    std::string GetName() {
+    std::string GetName() const {
         return dog_name_;
     }
 
-    const DogCoordinate& GetCoordinate() {
-        return dog_coordinate_;
+    DogCoordinate GetCoordinate() const {
+        return DogCoordinate{ states_->x[slot_], states_->y[slot_] };
     }
 
-    const DogCoordinate& GetEndPos() const {
-        return dog_coordinate_;
+    DogCoordinate GetEndPos() const {
+        return GetCoordinate();
     }
-    const DogCoordinate& GetStartPos() const {
-        return prev_dog_coordinate_;
+    DogCoordinate GetStartPos() const {
+        return DogCoordinate{ states_->prev_x[slot_], states_->prev_y[slot_] };
     }
 
-    void PickUpLoot(std::list<Loot>& session_loots, const auto& it_loot) {
-        loots_.splice(loots_.end(), session_loots, it_loot);
+    // moves the loot from the map to the bag
+    void PickUpLoot(LootPool::Handle loot) {
+        bag_.push_back(loot);
+        loot_pool_->PickUp(loot);
     }
 
-    std::list<Loot>& GetLoots() {
-        return loots_;
+    // puts the loot restored from the saved state to the bag, ReserveBag makes room for the whole bag first
+    void AddToBag(const Loot& loot) {
+        bag_.push_back(loot_pool_->Store(loot));
+    }
+
+    void ReserveBag(size_t bag_capacity) {
+        bag_.reserve(bag_capacity);
+    }
+
+    const Bag& GetBag() const noexcept {
+        return bag_;
+    }
+
+    template <typename Fn>
+    void ForEachLoot(Fn&& fn) const {
+        for (auto loot : bag_) {
+            fn(loot_pool_->Get(loot));
+        }
     }
 
     void ReturnLoots(const std::vector<int>& loot_scores) {
-        for (const auto& loot : loots_) {
-            score_ += loot_scores[loot.type];
+        for (auto loot : bag_) {
+            score_ += loot_scores[loot_pool_->Get(loot).type];
+            loot_pool_->Release(loot);
         }
-        return loots_.clear();
+        bag_.clear();
     }
 
     void SetCoordinate(const DogCoordinate& coordinate) {
-        std::swap(prev_dog_coordinate_, dog_coordinate_);
-        
-        dog_coordinate_.x = coordinate.x;
-        dog_coordinate_.y = coordinate.y;
+        states_->MoveTo(slot_, coordinate.x, coordinate.y);
     }
 
-    const DogSpeed& GetSpeed() {
-        return dog_speed_;
+    DogSpeed GetSpeed() const {
+        return DogSpeed{ states_->speed_x[slot_], states_->speed_y[slot_] };
     }
 
     void SetSpeed(const DogSpeed& speed) {
-        dog_speed_ = speed;
+        states_->SetSpeed(slot_, speed.x, speed.y);
     }
 
-    std::string GetDirection();
+    std::string GetDirection() const;
 
-    DOG_DIRECTION GetDirectionType() {
+    DOG_DIRECTION GetDirectionType() const {
         return dog_direction_;
     }
 
@@ -463,13 +589,14 @@ public:
 
     void Direction(DOG_MOVE dog_move, double speed);
 
-    DogCoordinate GetEndCoordinate(uint64_t move_time_ms);
+    DogCoordinate GetEndCoordinate(TimeDelta move_time) const;
 
-    bool IsStanding();
+    bool IsStanding() const {
+        return states_->IsStanding(slot_);
+    }
 
     void StopMove() {
-        dog_speed_.x = 0;
-        dog_speed_.y = 0;
+        states_->Stop(slot_);
     }
 
     int GetScore() const {
@@ -480,115 +607,71 @@ public:
         score_ = score;
     }
 
-    std::chrono::milliseconds GetStayTime() const {
-        return lifetime_-last_move_time_;
+    TimeDelta GetStayTime() const {
+        return states_->StayTime(slot_);
     }
 
-    std::chrono::milliseconds GetLifetime() const {
-        return lifetime_;
-    }
-
-    void IncLifetime(std::chrono::milliseconds time_delta) {
-        lifetime_ += time_delta;
-        if (dog_speed_ != DogSpeed{0, 0}) {
-            last_move_time_ = lifetime_;
-        }
+    TimeDelta GetLifetime() const {
+        return states_->Lifetime(slot_);
     }
 
-    void SetLastMoveTime(std::chrono::milliseconds time) {
-        last_move_time_ = time;
+    // lifetime of the dog when it stopped
+    void SetLastMoveTime(TimeDelta time) {
+        states_->last_move_time[slot_] = time;
     }
 
-    void SetLifeTime(std::chrono::milliseconds time) {
-        lifetime_ = time;
+    void SetLifeTime(TimeDelta time) {
+        states_->SetLifetime(slot_, time);
     }
 
-    Dog& operator=(const Dog& other);
-
-    Dog(const Dog& dog) : 
-        id_(dog.id_), 
-        dog_name_(dog.dog_name_), 
-        dog_coordinate_(dog.dog_coordinate_),
-        dog_speed_(dog.dog_speed_),
-        dog_direction_(dog.dog_direction_) {UPDATE_DOG_INDEX(*dog.id_);}
-
-    Dog(Dog&& dog) : 
-        id_(std::move(dog.id_)),
-        dog_name_(std::move(dog.dog_name_)),
-        dog_coordinate_(std::move(dog.dog_coordinate_)),
-        dog_speed_(std::move(dog.dog_speed_)),
-        dog_direction_(std::move(dog.dog_direction_)) {UPDATE_DOG_INDEX(*dog.id_);}
-
-     Dog(const std::string& name, const DogCoordinate& coordinate, Id id) :
-        dog_name_(name), 
-        dog_coordinate_(coordinate),
-        id_(id) {UPDATE_DOG_INDEX(*id);}
-
 private:
+
     Id id_ = Id{0};
     std::string dog_name_;
-    DogCoordinate dog_coordinate_;
-    DogSpeed dog_speed_{0, 0};
+    DogStates* states_;
+    size_t slot_;
+    LootPool* loot_pool_;
     DOG_DIRECTION dog_direction_ {DOG_DIRECTION::NORTH};
-    DogCoordinate prev_dog_coordinate_;
-    std::list<Loot> loots_;
+    Bag bag_;
     int score_ {0};
-    std::chrono::milliseconds last_move_time_{0};
-    std::chrono::milliseconds lifetime_{0};
-};
-
-
-class KeyHash {
-public:
-    template<typename T>
-    size_t operator()(const T& k) const {
-        return std::hash<decltype(k.x)>()(k.x) ^ (std::hash<decltype(k.y)>()(k.y) << 1);
-    }
 };
 
-class KeyEqual {
-public:
-    template<typename T>
-    bool operator()(const T& lhs, const T& rhs) const {
-        return lhs.x == rhs.x && lhs.y == rhs.y;
-    }
+// move of the dog requested by its player
+struct DogAction {
+    Dog::Id dog_id;
+    DOG_MOVE move;
 };
 
 class GameSession {
-    using RoadMap = std::unordered_multimap<Point, const Road*, KeyHash, KeyEqual>;
-    using RoadMapIter = decltype(RoadMap{}.equal_range(Point{}));
 public:
-    using Dogs = std::deque<Dog>;
+    // dogs never move in memory, so Dog* stays valid until the dog is deleted
+    using Dogs = SlotMap<Dog>;
     using Loots = std::list<Loot>;
 
     GameSession(
         const Map* map, 
         bool randomize_spawn_points,
-        const LootGeneratorConfig& loot_generator_config
+        const LootGeneratorConfig& loot_generator_config,
+        uint64_t random_seed
         ) : 
         map_(map),
         randomize_spawn_points_ (randomize_spawn_points),
+        random_engine_(random_seed),
         loot_generator_(
             loot_generator_config.period, 
             loot_generator_config.probability,
-            [&]() {
-                std::random_device random_device_;
-                auto random_coordinate = [&](auto x, auto y) {
-                        if (y < x) {
-                            std::swap(x, y);
-                        }
-                        std::uniform_real_distribution<double> dist(x, y);
-                        return dist(random_device_); 
-                };
-                return random_coordinate(0.0, 1.0);
+            [this]() {
+                return random_engine_.NextDouble();
             }
-        ) 
-    {
-            LoadRoadMap();
-    }
+        ) {}
+
+    // dogs refer to the session's DogStates, so the session stays in place
+    GameSession(const GameSession&) = delete;
+    GameSession& operator=(const GameSession&) = delete;
 
-    const Loots& GetLoots() const {
-        return loots_;
+    // loots lying on the map
+    const LootPool& GetLoots() const {
+        return loot_pool_;
     }
 
     const Loot::Id& GetLastLootId() const {
@@ -603,50 +686,51 @@ public:
         loot_id_ = loot_id;
     }
 
+    // puts the loots restored from the saved state on the map
     void SetLoots(const Loots& loots) {
-        loots_ = loots;
+        for (const auto& loot : loots) {
+            loot_pool_.Spawn(loot);
+        }
+        ++version_;
+    }
+
+    // changes with every tick and every action of the dogs, a reader's copy with the same version is up to date
+    uint64_t GetVersion() const noexcept {
+        return version_;
     }
 
     const Map::Id& MapId() {
         return map_->GetId();
     } 
 
+    // number of the session in the order the game opened or restored it, names the session in the logs
+    uint64_t GetId() const noexcept {
+        return id_;
+    }
+
+    void SetId(uint64_t id) noexcept {
+        id_ = id;
+    }
+
     Dog* FindDog(const std::string& nick_name);
 
     Dog* FindDog(Dog::Id dog_id)
     {
-        for (auto& dog : dogs_) {
-            if (*dog.GetId() == *dog_id)
-                return &dog;
+        if (auto it = dogs_by_id_.find(dog_id); it != dogs_by_id_.end()) {
+            return dogs_.Get(it->second);
         }
         return nullptr;
     }
 
     Dog* AddDog(const std::string& nick_name);
 
+    // adds a dog restored from the saved state
+    Dog* RestoreDog(const Dog::Id& dog_id, const std::string& nick_name, const DogCoordinate& coordinate);
+
     DogCoordinate GetRandomRoadCoordinate();
 
     const Dogs& GetDogs() const {
-        return const_cast<Dogs&>(dogs_);
-    }
-
-    void MoveDogToContainerAndIndexing(Dog&& dog) {
-        const size_t index = dogs_.size();
-        auto &o = dogs_.emplace_back(std::move(dog));
-        try {
-            dogs_id_to_index_.emplace(o.GetId(), index);
-        }
-        catch (...) {
-            dogs_.pop_back();
-            throw std::bad_alloc();
-        }
-    }
-
-    void SetDogs(const Dogs& dogs) {
-        for (auto it = dogs.begin(); it != dogs.end(); ++it) {
-            auto dog = *it;
-            MoveDogToContainerAndIndexing(std::move(dog));
-        }
+        return dogs_;
     }
 
     const Dog::Id& GetLastDogId() const {
@@ -659,36 +743,313 @@ public:
 
     void MoveDog(const Dog::Id& dog_id, const DOG_MOVE& dog_move);
 
-    void Tick(uint64_t time_delta);
+    // the session writes the joins, moves and leaves of its dogs to recorder under the serial number
+    void SetRecorder(GameRecorder* recorder, uint32_t serial) noexcept {
+        recorder_ = recorder;
+        record_serial_ = serial;
+    }
 
-    DogCoordinate MoveDog(const DogCoordinate& start_coordinate, const DogCoordinate& end_coordinate);
+    // applies the newest queued move of every dog, Game::Tick calls it for all sessions in one thread
+    void ApplyQueuedMoves();
 
-    bool IsCoordinateOnRoad(const RoadMapIter& roads, const DogCoordinate& coordinate);
+    using MoveQueue = ActionQueue<DogAction>;
 
-    DogCoordinate FindBorderCoordinate(const RoadMapIter& roads, const DogCoordinate& end_coordinate);
+    /*
+     * Очередь движений собак, которую можно пополнять из любого потока.
+     * Движения применяются в начале следующего тика, из нескольких движений одной собаки
+     * побеждает последнее. Очередь переживает сессию, поэтому её можно хранить вне потока симуляции.
+     */
+    const std::shared_ptr<MoveQueue>& GetMoveQueue() const noexcept {
+        return move_queue_;
+    }
 
-    void LoadRoadMap();
+    /*
+     * С executor большая сессия обновляется параллельно по пространственным областям:
+     * собаки двигаются порциями, а поиск событий сбора идёт в вертикальных полосах карты
+     * с равным числом предметов. События областей сливаются в одном порядке и применяются
+     * в одном потоке, поэтому результат совпадает с тиком без executor.
+     */
+    void Tick(TimeDelta time_delta, TickExecutor* executor = nullptr);
 
-    void PickUpAndReturnLoots();
+    /*
+     * Сессия спит, если в ней нет движущихся собак и генератор не может добавить трофеи.
+     * Тик такой сессии ничего не меняет, поэтому Game::Tick только продвигает её часы через Idle.
+     * Сессию будит первое действие: движение собаки, в том числе из очереди, или вход нового игрока.
+     */
+    bool IsDormant() const noexcept {
+        return dog_states_.active.empty() && loot_pool_.Size() >= dogs_.Size() && move_queue_->Empty();
+    }
 
-    void PushLootsToMap(std::chrono::milliseconds time_delta_ms);
+    void Idle(TimeDelta time_delta);
+
+    // phase times of the last Tick, Idle doesn't change them
+    const TickPhaseTimes& GetLastTickTimes() const noexcept {
+        return last_tick_times_;
+    }
+
+    // histograms of the ticks since the previous call
+    TickProfile TakeTickProfile() noexcept {
+        return std::exchange(tick_profile_, TickProfile{});
+    }
+
+    // how long the session has had no dogs, reset by the first tick with a dog
+    TimeDelta GetEmptyTime() const noexcept {
+        return empty_time_;
+    }
+
+    /*
+     * Moves the dog along one axis from start_coordinate towards end_coordinate
+     * and returns the point where it stops: end_coordinate or the border of the roads.
+     * The walk jumps from one road end to the next one, so the result doesn't depend
+     * on how the time is split into ticks and costs O(1) per passed road.
+     */
+    DogCoordinate MoveDog(const DogCoordinate& start_coordinate, const DogCoordinate& end_coordinate);
+
+    // farthest coordinate along the axis inside the roads of the cell containing position
+    double FindRoadReach(const DogCoordinate& position, bool along_x, bool forward) const;
+
+    void PushLootsToMap(TimeDelta time_delta);
 
     void DeleteDog(const Dog::Id& dog_id);
 
 private:
+    template <typename... Args>
+    Dog* PlaceDog(const DogCoordinate& coordinate, const Args&... dog_args);
+
+    void CompactDogs();
+
+    void TrackEmptyTime(TimeDelta time_delta) noexcept;
+
+    void MoveActiveDogs(TickExecutor* executor);
+
+    // laps the broadphase, narrowphase and events phases
+    void PickUpAndReturnLoots(PhaseTimer& timer, TickExecutor* executor);
+
+    void FindGatherEventsInRegions(PhaseTimer& timer, TickExecutor& executor);
+
+    static size_t RegionsCount(const TickExecutor& executor) noexcept;
+
+    // items and gatherers of one stripe of the map, ids map them back to the whole session
+    struct GatherRegion {
+        collision_detector::ItemGatherer item_gatherer;
+        collision_detector::GatherScratch scratch;
+        std::vector<size_t> item_ids;
+        std::vector<size_t> gatherer_ids;
+        std::vector<collision_detector::GatheringEvent> events;
+    };
+
     using DogsIdHasher = util::TaggedHasher<Dog::Id>;
-    using DogsIdToIndex = std::unordered_map<Dog::Id, size_t, DogsIdHasher>;
+    using DogsIdToHandle = std::unordered_map<Dog::Id, Dogs::Handle, DogsIdHasher>;
+    using DogsNameToHandle = std::unordered_map<std::string, Dogs::Handle>;
+    // cold dog data, the dog in slot i of dogs_ owns slot i of dog_states_, free slots stand still
     Dogs dogs_;
-    DogsIdToIndex dogs_id_to_index_;
+    DogStates dog_states_;
+    DogsIdToHandle dogs_by_id_;
+    DogsNameToHandle dogs_by_name_;
     const Map* map_;
-    RoadMap road_map_;
     bool randomize_spawn_points_;
+    RandomEngine random_engine_;
     loot_gen::LootGenerator loot_generator_;
-    Loots loots_;
+    LootPool loot_pool_;
+    std::shared_ptr<MoveQueue> move_queue_ {std::make_shared<MoveQueue>()};
+    std::vector<DogAction> queued_moves_;
+    // slots of the dogs moved by the current tick, only they can gather
+    std::vector<uint32_t> moved_slots_;
+    // scratch buffers of PickUpAndReturnLoots
+    LootPool::Handles gathered_loots_;
+    std::vector<Dog*> gatherer_dogs_;
+    collision_detector::ItemGatherer item_gatherer_;
+    collision_detector::GatherScratch gather_scratch_;
+    std::vector<collision_detector::GatheringEvent> gather_events_;
+    // scratch buffers of the tick split into regions
+    std::vector<std::vector<uint32_t>> stopped_slots_;
+    std::vector<TickExecutor::Cost> move_costs_;
+    std::vector<GatherRegion> regions_;
+    std::vector<double> region_xs_;
+    std::vector<double> region_borders_;
+    std::vector<TickExecutor::Cost> region_costs_;
     Loot::Id loot_id_ {0};
     Dog::Id dog_id_{0};
+    TimeDelta empty_time_{0};
+    uint64_t version_ {0};
+    uint64_t id_ {0};
+    TickPhaseTimes last_tick_times_;
+    TickProfile tick_profile_;
+    GameRecorder* recorder_ {nullptr};
+    uint32_t record_serial_ {0};
+};
+
+
+
+// breakdown of a session tick longer than the slow tick threshold
+struct SlowSessionTick {
+    uint64_t session_id;
+    Map::Id map_id;
+    size_t dogs;
+    size_t loots;
+    TickPhaseTimes times;
 };
 
+class Game {
+public:
+    Game(const LootGeneratorConfig& loot_generator_config) : loot_generator_config_(std::move(loot_generator_config)) {}
+
+    using Maps = std::vector<Map>;
+
+    using GameSessions = std::deque<std::unique_ptr<GameSession>>;
+
+    void AddMap(const Map& map);
+
+    const Maps& GetMaps() const noexcept {
+        return maps_;
+    }
+
+    void SetDefaultDogSpeed(double speed) {
+        DefaultDogSpeed = speed;
+    }
+
+    void SetDefaultBagCapacity(int bag_capacity) {
+        DefaultBagCapacity = bag_capacity;
+    }
+
+    const Map* FindMap(const Map::Id& id) const noexcept;
+
+    // least loaded session (shard) of the map which has room for one more player
+    GameSession* FindGameSession(const Map::Id& id) noexcept;
+
+    // session of the map which contains the dog
+    GameSession* FindDogSession(const Map::Id& id, const Dog::Id& dog_id) noexcept;
+
+    // opens one more session (shard) of the map
+    GameSession* AddGameSession(const Map::Id& id);
+
+    /*
+     * Сессия, в которой не было игроков в течение empty_time, удаляется вместе со своими трофеями
+     * и буферами, поэтому память возвращается к исходной после наплыва игроков.
+     * Следующий игрок карты откроет новую сессию. Значение 0 оставляет пустые сессии навсегда.
+     */
+    void SetSessionEmptyTime(TimeDelta empty_time) {
+        session_empty_time_ = empty_time;
+    }
+
+    TimeDelta GetSessionEmptyTime() const noexcept {
+        return session_empty_time_;
+    }
+
+    void Tick(TimeDelta time_delta);
+
+    using SlowTickHandler = std::function<void(const SlowSessionTick&)>;
+
+    /*
+     * После каждого тика handler получает разбивку по фазам для каждой сессии,
+     * тик которой занял больше threshold. Вызывается в потоке, выполняющем Tick.
+     */
+    void SetSlowTickHandler(TickPhaseTimes::Clock::duration threshold, SlowTickHandler handler) {
+        slow_tick_threshold_ = threshold;
+        slow_tick_handler_ = std::move(handler);
+    }
+
+    // phase histograms of all session ticks since the previous call, including the reclaimed sessions
+    TickProfile TakeTickProfile();
+
+    // sessions are ticked in parallel when threads_count > 1
+    void SetTickThreads(unsigned threads_count) {
+        tick_executor_ = threads_count > 1 ? std::make_unique<TickExecutor>(threads_count) : nullptr;
+    }
+
+    // a session with at least dogs_count dogs is split into spatial regions ticked on all threads
+    void SetSessionPartitionMinDogs(size_t dogs_count) {
+        partition_min_dogs_ = dogs_count;
+    }
+
+    void SetRandomizeSpawnPoints(bool randomize_spawn_points) {
+        randomize_spawn_points_ = randomize_spawn_points;
+    }
 
+    bool IsRandomizeSpawnPoints() {
+        return randomize_spawn_points_;
+    }
+
+    // sessions get seeds random_seed, random_seed + 1, ... in the order they are opened
+    void SetRandomSeed(uint64_t random_seed) {
+        random_seed_ = random_seed;
+    }
+
+    const std::optional<uint64_t>& GetRandomSeed() const noexcept {
+        return random_seed_;
+    }
+
+    /*
+     * Записывает все последующие операции над игрой в recorder для воспроизведения через GameReplay.
+     * Запись начинается с пустой игры с заданным зерном, иначе повтор разойдётся с оригиналом.
+     */
+    void SetRecorder(GameRecorder* recorder);
+
+    // seed of the next session: derived from the configured seed or taken from std::random_device
+    uint64_t MakeSessionSeed();
+
+    std::string GetLootType(const Map::Id& id) {
+        return loot_type_.GetLootType(*id);
+    }
+
+    void AddLootType(const extra_data::LootType& loot_type) {
+        loot_type_ = std::move(loot_type);
+    }
+
+    GameSessions& GetGameSessions() {
+        return game_sessions_;
+    }
+
+    void SetGameSessions(GameSessions&& game_sessions);
+
+    const LootGeneratorConfig& GetLootGeneratorConfig() const {
+        return loot_generator_config_;
+    }
+
+    void SetRetirementTime(double retirement_time) {
+        retirement_time_ = std::chrono::milliseconds(static_cast<size_t>(retirement_time));
+    }
+
+    TimeDelta GetRetirementTime() const {
+        return retirement_time_;
+    }
+
+private:
+    using MapIdHasher = util::TaggedHasher<Map::Id>;
+    using MapIdToIndex = std::unordered_map<Map::Id, size_t, MapIdHasher>;
+    using MapIdToSessions = std::unordered_map<Map::Id, std::vector<GameSession*>, MapIdHasher>;
+
+    // removes the sessions which have been empty for session_empty_time_
+    void ReclaimGameSessions();
+
+    void CheckSlowTick(GameSession& game_session);
+     
+    Maps maps_;
+    double DefaultDogSpeed {0.0};
+    int DefaultBagCapacity {0};
+    GameSessions game_sessions_;
+    MapIdToIndex map_id_to_index_;
+    MapIdToSessions map_id_to_game_sessions_;
+    bool randomize_spawn_points_ {false};
+    std::optional<uint64_t> random_seed_;
+    uint64_t sessions_seeded_ {0};
+    uint64_t sessions_opened_ {0};
+    GameRecorder* recorder_ {nullptr};
+    LootGeneratorConfig loot_generator_config_;
+    extra_data::LootType loot_type_;
+    TimeDelta retirement_time_{0};
+    TimeDelta session_empty_time_{0};
+    std::unique_ptr<TickExecutor> tick_executor_;
+    size_t partition_min_dogs_ {2048};
+    // measured tick cost of game_sessions_[i]
+    std::vector<TickExecutor::Cost> tick_costs_;
+    // indexes of the sessions that aren't dormant in the current tick and their costs
+    std::vector<size_t> awake_sessions_;
+    std::vector<TickExecutor::Cost> awake_costs_;
+    TickPhaseTimes::Clock::duration slow_tick_threshold_ {0};
+    SlowTickHandler slow_tick_handler_;
+    // histograms of the sessions reclaimed since the last TakeTickProfile
+    TickProfile reclaimed_profile_;
+};
 
 }  // namespace model
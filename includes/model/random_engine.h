@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace model {
+
+/*
+ *  Быстрый генератор псевдослучайных чисел xoshiro256** для игровой сессии.
+ *  Состояние занимает 32 байта и инициализируется из 64-битного зерна через splitmix64,
+ *  поэтому при одинаковом зерне последовательность воспроизводится.
+ *  Удовлетворяет требованиям UniformRandomBitGenerator.
+ */
+class RandomEngine {
+public:
+    using result_type = uint64_t;
+
+    explicit RandomEngine(uint64_t seed) noexcept {
+        for (auto& word : state_) {
+            seed += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    static constexpr result_type min() noexcept {
+        return 0;
+    }
+
+    static constexpr result_type max() noexcept {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() noexcept {
+        const uint64_t result = Rotl(state_[1] * 5, 7) * 9;
+        const uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = Rotl(state_[3], 45);
+        return result;
+    }
+
+    // uniform in [0, 1)
+    double NextDouble() noexcept {
+        return static_cast<double>((*this)() >> 11) * 0x1.0p-53;
+    }
+
+    // uniform in [0, count), count > 0
+    size_t NextIndex(size_t count) noexcept {
+        return static_cast<size_t>((static_cast<unsigned __int128>((*this)()) * count) >> 64);
+    }
+
+private:
+    static uint64_t Rotl(uint64_t value, int shift) noexcept {
+        return (value << shift) | (value >> (64 - shift));
+    }
+
+    uint64_t state_[4];
+};
+
+}  // namespace model
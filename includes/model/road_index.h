@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace model {
+
+class Road;
+
+// Road bounds inflated by the road half-width
+struct RoadBounds {
+    double x0;
+    double x1;
+    double y0;
+    double y1;
+};
+
+/*
+ *  Неизменяемый индекс дорог карты.
+ *  Строится один раз при загрузке карты и разделяется всеми игровыми сессиями этой карты.
+ *  Горизонтальные и вертикальные дороги хранятся в отдельных массивах интервалов,
+ *  отсортированных по (линия, начало), поэтому поиск дорог, содержащих клетку, стоит O(log n).
+ */
+class RoadIndex {
+public:
+    static constexpr double ROAD_HALF_WIDTH = 0.4;
+
+    explicit RoadIndex(const std::vector<Road>& roads);
+
+    /*
+     * Вызывает fn(const RoadBounds&) для каждой дороги, проходящей через клетку (x, y)
+     */
+    template <typename Fn>
+    void ForEachRoad(int x, int y, Fn&& fn) const {
+        ForEachInterval(horizontal_, y, x, fn);
+        ForEachInterval(vertical_, x, y, fn);
+    }
+
+    size_t GetRoadsCount() const noexcept {
+        return horizontal_.size() + vertical_.size();
+    }
+
+    // memory occupied by the index in bytes
+    size_t GetMemoryUsage() const noexcept;
+
+private:
+    struct Interval {
+        // horizontal: line = y, [from, to] = [x0, x1]; vertical: line = x, [from, to] = [y0, y1]
+        int line;
+        int from;
+        int to;
+        // max of `to` over intervals of the same line up to this one
+        int max_to;
+        RoadBounds bounds;
+    };
+    using Intervals = std::vector<Interval>;
+
+    template <typename Fn>
+    static void ForEachInterval(const Intervals& intervals, int line, int pos, Fn& fn) {
+        // first interval after (line, pos): every candidate lies before it
+        auto it = UpperBound(intervals, line, pos);
+        while (it != intervals.begin()) {
+            --it;
+            if (it->line != line || it->max_to < pos) {
+                break;
+            }
+            if (it->to >= pos) {
+                fn(it->bounds);
+            }
+        }
+    }
+
+    static Intervals::const_iterator UpperBound(const Intervals& intervals, int line, int pos);
+
+    static void Finalize(Intervals& intervals);
+
+    Intervals horizontal_;
+    Intervals vertical_;
+};
+
+}  // namespace model
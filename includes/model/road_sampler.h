@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <random_engine.h>
+
+namespace model {
+
+class Road;
+
+struct RoadPoint {
+    double x;
+    double y;
+};
+
+/*
+ *  Выбор случайной точки на дорогах карты с вероятностью, пропорциональной длине дороги.
+ *  Таблица псевдонимов (alias method) строится один раз при загрузке карты
+ *  и разделяется всеми игровыми сессиями, поэтому выбор точки стоит O(1).
+ */
+class RoadSampler {
+public:
+    explicit RoadSampler(const std::vector<Road>& roads);
+
+    bool IsEmpty() const noexcept {
+        return segments_.empty();
+    }
+
+    // random point on a random road, roads must not be empty
+    RoadPoint Sample(RandomEngine& engine) const noexcept;
+
+private:
+    struct Segment {
+        double x;
+        double y;
+        double dx;
+        double dy;
+    };
+
+    std::vector<Segment> segments_;
+    // probability to keep the column, otherwise alias_ is taken
+    std::vector<double> probability_;
+    std::vector<uint32_t> alias_;
+};
+
+}  // namespace model
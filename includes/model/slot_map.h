@@ -0,0 +1,218 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace model {
+
+/*
+ *  Хранилище объектов с устойчивыми дескрипторами (generational slot map).
+ *  Объекты лежат в слотах std::deque и никогда не перемещаются, поэтому указатели на живые объекты
+ *  остаются действительными. Удаление освобождает слот за O(1) и увеличивает его поколение,
+ *  так что устаревший дескриптор больше не находит объект. Освободившиеся слоты используются повторно,
+ *  Compact отбрасывает свободные слоты в конце хранилища, но помнит их поколения,
+ *  поэтому слот, созданный заново на том же месте, не совпадает со старыми дескрипторами.
+ */
+template <typename T>
+class SlotMap {
+    struct Slot {
+        uint32_t generation {0};
+        std::optional<T> value;
+    };
+    using Slots = std::deque<Slot>;
+
+public:
+    struct Handle {
+        uint32_t index {0};
+        uint32_t generation {0};
+
+        bool operator==(const Handle&) const = default;
+    };
+
+    template <typename SlotIterator, typename Value>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        Iterator() = default;
+        Iterator(SlotIterator it, SlotIterator end) : it_(it), end_(end) {
+            SkipFree();
+        }
+
+        reference operator*() const {
+            return *it_->value;
+        }
+
+        pointer operator->() const {
+            return &*it_->value;
+        }
+
+        Iterator& operator++() {
+            ++it_;
+            SkipFree();
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return it_ == other.it_;
+        }
+
+    private:
+        void SkipFree() {
+            while (it_ != end_ && !it_->value) {
+                ++it_;
+            }
+        }
+
+        SlotIterator it_;
+        SlotIterator end_;
+    };
+
+    using iterator = Iterator<typename Slots::iterator, T>;
+    using const_iterator = Iterator<typename Slots::const_iterator, const T>;
+
+    // index of the slot the next Emplace will occupy
+    uint32_t NextIndex() const noexcept {
+        return free_.empty() ? static_cast<uint32_t>(slots_.size()) : free_.back();
+    }
+
+    template <typename... Args>
+    Handle Emplace(Args&&... args) {
+        if (free_.empty()) {
+            auto& slot = slots_.emplace_back();
+            if (slots_.size() <= dropped_generations_.size()) {
+                slot.generation = dropped_generations_[slots_.size() - 1];
+            }
+            try {
+                slot.value.emplace(std::forward<Args>(args)...);
+            }
+            catch (...) {
+                slots_.pop_back();
+                throw;
+            }
+            ++size_;
+            return Handle{static_cast<uint32_t>(slots_.size() - 1), slot.generation};
+        }
+        auto index = free_.back();
+        auto& slot = slots_[index];
+        slot.value.emplace(std::forward<Args>(args)...);
+        free_.pop_back();
+        ++size_;
+        return Handle{index, slot.generation};
+    }
+
+    // returns false when the handle is stale
+    bool Erase(Handle handle) {
+        if (Get(handle) == nullptr) {
+            return false;
+        }
+        // the only throwing step goes first, so a failure leaves the map untouched
+        free_.push_back(handle.index);
+        auto& slot = slots_[handle.index];
+        slot.value.reset();
+        ++slot.generation;
+        --size_;
+        return true;
+    }
+
+    T* Get(Handle handle) noexcept {
+        return const_cast<T*>(std::as_const(*this).Get(handle));
+    }
+
+    const T* Get(Handle handle) const noexcept {
+        if (handle.index >= slots_.size()) {
+            return nullptr;
+        }
+        const auto& slot = slots_[handle.index];
+        return slot.generation == handle.generation && slot.value ? &*slot.value : nullptr;
+    }
+
+    // live object in the slot index regardless of its generation
+    T* At(uint32_t index) noexcept {
+        if (index >= slots_.size() || !slots_[index].value) {
+            return nullptr;
+        }
+        return &*slots_[index].value;
+    }
+
+    // drops the free slots at the end of the storage, live objects stay in place
+    void Compact() {
+        size_t size = slots_.size();
+        while (size != 0 && !slots_[size - 1].value) {
+            --size;
+        }
+        if (size == slots_.size()) {
+            return;
+        }
+        // the only throwing step goes first, so a failure leaves the map untouched
+        if (dropped_generations_.size() < slots_.size()) {
+            dropped_generations_.resize(slots_.size());
+        }
+        for (size_t index = size; index < slots_.size(); ++index) {
+            dropped_generations_[index] = slots_[index].generation;
+        }
+        while (slots_.size() != size) {
+            slots_.pop_back();
+        }
+        std::erase_if(free_, [size = slots_.size()](uint32_t index) {
+            return index >= size;
+        });
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    bool Empty() const noexcept {
+        return size_ == 0;
+    }
+
+    // number of slots including the free ones
+    size_t Capacity() const noexcept {
+        return slots_.size();
+    }
+
+    size_t FreeCount() const noexcept {
+        return free_.size();
+    }
+
+    iterator begin() {
+        return iterator(slots_.begin(), slots_.end());
+    }
+
+    iterator end() {
+        return iterator(slots_.end(), slots_.end());
+    }
+
+    const_iterator begin() const {
+        return const_iterator(slots_.begin(), slots_.end());
+    }
+
+    const_iterator end() const {
+        return const_iterator(slots_.end(), slots_.end());
+    }
+
+private:
+    Slots slots_;
+    std::vector<uint32_t> free_;
+    // generations of the slots dropped by Compact, never shrinks
+    std::vector<uint32_t> dropped_generations_;
+    size_t size_ {0};
+};
+
+}  // namespace model
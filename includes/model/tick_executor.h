@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace model {
+
+/*
+ *  Пул потоков с перехватом задач (work stealing) для параллельного тика игровых сессий.
+ *  Задачи распределяются по очередям потоков по измеренной стоимости (сначала самые тяжёлые),
+ *  освободившийся поток забирает задачи из хвоста чужих очередей.
+ *  Run возвращает управление только после завершения всех задач.
+ */
+class TickExecutor {
+public:
+    using Task = std::function<void(size_t index)>;
+    using Cost = std::chrono::nanoseconds;
+
+    // threads_count includes the thread calling Run
+    explicit TickExecutor(unsigned threads_count);
+    ~TickExecutor();
+
+    TickExecutor(const TickExecutor&) = delete;
+    TickExecutor& operator=(const TickExecutor&) = delete;
+
+    /*
+     * Вызывает task(i) для каждого i из [0, costs.size()) и дожидается их завершения.
+     * costs[i] - ожидаемая стоимость задачи i, после выполнения заменяется сглаженной измеренной.
+     */
+    void Run(std::vector<Cost>& costs, const Task& task);
+
+    unsigned GetThreadsCount() const noexcept {
+        return static_cast<unsigned>(queues_.size());
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    void Distribute(const std::vector<Cost>& costs);
+    void WorkerLoop(size_t queue_index);
+    void Execute(size_t queue_index);
+    bool PopOwn(size_t queue_index, size_t& task_index);
+    bool Steal(size_t queue_index, size_t& task_index);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::jthread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    size_t generation_ {0};
+    size_t remaining_ {0};
+    bool stop_ {false};
+
+    // state of the current Run
+    const Task* task_ {nullptr};
+    std::vector<Cost>* costs_ {nullptr};
+    std::exception_ptr exception_;
+
+    // scratch buffers of Distribute
+    std::vector<size_t> order_;
+    std::vector<Cost> loads_;
+};
+
+}  // namespace model
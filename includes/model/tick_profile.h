@@ -0,0 +1,176 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace model {
+
+// Фазы тика игровой сессии в порядке выполнения
+enum class TickPhase : size_t {
+    MOVEMENT,
+    LOOT_GENERATION,
+    // the gatherers and items of the tick, the grid or the regions over them
+    BROADPHASE,
+    // segment to point tests and the order of the events
+    NARROWPHASE,
+    // pick-ups and returns of the found events
+    EVENTS
+};
+
+inline constexpr size_t TICK_PHASE_COUNT = 5;
+
+inline constexpr std::array<std::string_view, TICK_PHASE_COUNT> TICK_PHASE_NAMES {
+    "movement",
+    "lootGeneration",
+    "broadphase",
+    "narrowphase",
+    "events"
+};
+
+// time spent in every phase of one session tick
+struct TickPhaseTimes {
+    using Clock = std::chrono::steady_clock;
+
+    Clock::duration& operator[](TickPhase phase) noexcept {
+        return phases[static_cast<size_t>(phase)];
+    }
+
+    Clock::duration operator[](TickPhase phase) const noexcept {
+        return phases[static_cast<size_t>(phase)];
+    }
+
+    Clock::duration Total() const noexcept {
+        Clock::duration total {0};
+        for (auto phase : phases) {
+            total += phase;
+        }
+        return total;
+    }
+
+    std::array<Clock::duration, TICK_PHASE_COUNT> phases {};
+};
+
+// measures consecutive phases, one clock read per phase
+class PhaseTimer {
+public:
+    using Clock = TickPhaseTimes::Clock;
+
+    // the times start from zero
+    explicit PhaseTimer(TickPhaseTimes& times) noexcept
+        : times_{times}
+        , start_{Clock::now()} {
+        times_ = TickPhaseTimes{};
+    }
+
+    // the phase took the time since the previous lap, a phase may be lapped several times
+    void Lap(TickPhase phase) noexcept {
+        const auto now = Clock::now();
+        times_[phase] += now - start_;
+        start_ = now;
+    }
+
+    // a part of the lapped time of one phase measured elsewhere belongs to another phase
+    void Reassign(TickPhase from, TickPhase to, Clock::duration time) noexcept {
+        time = std::min(time, times_[from]);
+        times_[from] -= time;
+        times_[to] += time;
+    }
+
+private:
+    TickPhaseTimes& times_;
+    Clock::time_point start_;
+};
+
+/*
+ *  Гистограмма длительностей с логарифмическими корзинами: корзина 0 - меньше микросекунды,
+ *  корзина i - от 2^(i-1) до 2^i микросекунд, последняя корзина - всё, что длиннее.
+ *  Добавление стоит несколько инструкций, поэтому гистограммы обновляются на каждом тике.
+ */
+class DurationHistogram {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t BUCKETS_COUNT = 24;
+
+    void Add(Clock::duration time) noexcept {
+        const auto us = static_cast<uint64_t>(std::max<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(time).count(), 0));
+        ++buckets_[std::min<size_t>(std::bit_width(us), BUCKETS_COUNT - 1)];
+        ++count_;
+        total_ += time;
+        max_ = std::max(max_, time);
+    }
+
+    void Merge(const DurationHistogram& other) noexcept {
+        for (size_t bucket = 0; bucket < BUCKETS_COUNT; ++bucket) {
+            buckets_[bucket] += other.buckets_[bucket];
+        }
+        count_ += other.count_;
+        total_ += other.total_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    uint64_t Count() const noexcept {
+        return count_;
+    }
+
+    Clock::duration Total() const noexcept {
+        return total_;
+    }
+
+    Clock::duration Max() const noexcept {
+        return max_;
+    }
+
+    // upper bound of the bucket holding the share of the samples, not above the max
+    Clock::duration Percentile(double share) const noexcept {
+        if (count_ == 0) {
+            return Clock::duration{0};
+        }
+        const auto rank = static_cast<uint64_t>(share * static_cast<double>(count_ - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t bucket = 0; bucket < BUCKETS_COUNT; ++bucket) {
+            seen += buckets_[bucket];
+            if (seen >= rank && bucket + 1 < BUCKETS_COUNT) {
+                return std::min<Clock::duration>(std::chrono::microseconds{uint64_t{1} << bucket}, max_);
+            }
+        }
+        // the last bucket has no upper bound
+        return max_;
+    }
+
+    const std::array<uint64_t, BUCKETS_COUNT>& GetBuckets() const noexcept {
+        return buckets_;
+    }
+
+private:
+    std::array<uint64_t, BUCKETS_COUNT> buckets_ {};
+    uint64_t count_ {0};
+    Clock::duration total_ {0};
+    Clock::duration max_ {0};
+};
+
+// histograms of the whole session ticks and of their phases
+struct TickProfile {
+    void Add(const TickPhaseTimes& times) noexcept {
+        for (size_t phase = 0; phase < TICK_PHASE_COUNT; ++phase) {
+            phases[phase].Add(times.phases[phase]);
+        }
+        ticks.Add(times.Total());
+    }
+
+    void Merge(const TickProfile& other) noexcept {
+        for (size_t phase = 0; phase < TICK_PHASE_COUNT; ++phase) {
+            phases[phase].Merge(other.phases[phase]);
+        }
+        ticks.Merge(other.ticks);
+    }
+
+    DurationHistogram ticks;
+    std::array<DurationHistogram, TICK_PHASE_COUNT> phases;
+};
+
+}  // namespace model
@@ -36,11 +36,14 @@ protected:
         // Запись выполняется асинхронно, поэтому response перемещаем в область кучи
         auto safe_response = std::make_shared<http::response<Body, Fields>>(std::move(response));
 
+        // ответ может прийти из потока симуляции, запись запускаем в strand сокета
         auto self = GetSharedThis();
-        http::async_write(stream_, *safe_response,
-                          [safe_response, self](beast::error_code ec, std::size_t bytes_written) {
-                              self->OnWrite(safe_response->need_eof(), ec, bytes_written);
-                          });
+        net::dispatch(stream_.get_executor(), [this, safe_response, self] {
+            http::async_write(stream_, *safe_response,
+                              [safe_response, self](beast::error_code ec, std::size_t bytes_written) {
+                                  self->OnWrite(safe_response->need_eof(), ec, bytes_written);
+                              });
+        });
     }
 
     SessionBase(tcp::socket&& socket) : stream_(std::move(socket)) {}
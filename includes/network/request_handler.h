@@ -28,12 +28,21 @@ struct Args {
     std::vector<std::string> source;
     std::string config_file;
     std::string save_file;
+    // operations applied to the game are written there for game_replay
+    std::string record_file;
     std::string www_root;
-    uint64_t tick_time;
+    uint64_t tick_time {0};
+    // the game ticker may stretch its period up to it under load, 0 keeps the rate fixed
+    uint64_t max_tick_time {0};
+    // session ticks and scheduled tasks longer than it are logged with their phases, 0 logs nothing
+    uint64_t slow_tick_time {0};
+    unsigned tick_threads {1};
+    std::optional<unsigned> simulation_cpu;
     bool use_tick_api {false};
     bool randomize_spawn_points {false};
     std::chrono::milliseconds save_state_period;
     std::shared_ptr<application::Application> application;
+    std::shared_ptr<ticker::Scheduler> scheduler;
     bool save_state {false};
 };
 
@@ -61,19 +70,26 @@ public:
 
         try {
             /*req относится к API?*/
-            if (url_path.find("/api") == 0) {
+            if (url_path.find("/api") == 0 && api_response.IsConcurrent(req)) {
+                // чтение опубликованного состояния и постановка команд в очередь не переходят в поток симуляции
+                auto handled_req = api_response.HandleRequest(req);
+                GetResponseData(handled_req, response_data);
+                return SendRequest(handled_req, send);
+            }
+            else if (url_path.find("/api") == 0) {
+                // the request is handled later in the simulation thread, so the lambda owns it
                 auto handle = [
                     this, 
                     send,
-                    &req,
+                    req = std::move(req),
                     response_data,
                     version, 
                     keep_alive
-                ] {
+                ]() mutable {
                     try {
                         // Этот assert не выстрелит, так как лямбда-функция будет выполняться внутри strand
                         assert(api_strand_.running_in_this_thread());
-                        auto handled_req = api_response.HandleRequest(std::forward<decltype(req)>(req));
+                        auto handled_req = api_response.HandleRequest(std::move(req));
                         // get response data
                         GetResponseData(handled_req, response_data);
                         return SendRequest(handled_req, send);
@@ -82,7 +98,7 @@ public:
                         //send(self->ReportServerError(version, keep_alive));
                     }
                 };
-                return boost::asio::dispatch(api_strand_, handle);
+                return boost::asio::post(api_strand_, std::move(handle));
             }
             else {
                 // Возвращаем результат обработки запроса к файлу
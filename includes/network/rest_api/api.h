@@ -1,6 +1,7 @@
 #pragma once
 #include <network/rest_api/response_base.h>
 #include <application.h>
+#include <scheduler.h>
 
 namespace http_handler {
 
@@ -18,6 +19,8 @@ enum API_TYPE {
 class Api : public ResponseBase {
     application::Application& app_;
     bool use_tick_api_;
+    // the tick API advances the clock of the scheduler
+    ticker::Scheduler& scheduler_;
 
     virtual Response MakeGetHeadResponse(const StringRequest& req) override;
 	virtual Response MakePostResponse(const StringRequest& req) override;
@@ -33,9 +36,13 @@ class Api : public ResponseBase {
     StringResponse ExecuteAuthorized(const StringRequest& request, Fn&& app_action);
 
 public:
-	Api(application::Application& app, bool use_tick_api) : 
+	Api(application::Application& app, bool use_tick_api, ticker::Scheduler& scheduler) : 
         app_(app), 
-        use_tick_api_(use_tick_api) {}
+        use_tick_api_(use_tick_api),
+        scheduler_(scheduler) {}
+
+    // the request reads the maps or the published state or queues an action, so it may be handled in any thread
+    bool IsConcurrent(const StringRequest& req) const;
 };
 
 };
\ No newline at end of file
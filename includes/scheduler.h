@@ -0,0 +1,128 @@
+#pragma once
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <string>
+#include <vector>
+#include <tick_rate_controller.h>
+#include <model/tick_profile.h>
+
+namespace ticker {
+namespace net = boost::asio;
+namespace sys = boost::system;
+using namespace std::chrono;
+
+/*
+ *  Планировщик периодических задач потока симуляции.
+ *  Задачи регистрируются со своим периодом, фазой и приоритетом и хранятся в куче по сроку,
+ *  поэтому один таймер обслуживает все задачи. Каждая задача выполняется ровно один раз на свой срок:
+ *  пропущенные сроки не догоняются, задача получает реально прошедшее с её прошлого запуска время.
+ *  Задачи с одним сроком выполняются по возрастанию приоритета. Задача с follows не имеет своего срока:
+ *  она выполняется сразу после каждого запуска ведущей задачи и следует её растянутому периоду,
+ *  а её стоимость входит в нагрузку ведущей задачи. Стоимость запусков собирается
+ *  в гистограмму каждой задачи, запуск дольше slow_cost сразу пишется в лог.
+ *  Start запускает задачи по реальному времени, Advance продвигает время вручную (запрос /api/v1/game/tick).
+ */
+class Scheduler : public std::enable_shared_from_this<Scheduler> {
+public:
+    using Strand = net::strand<net::io_context::executor_type>;
+    using Clock = steady_clock;
+    // the same resolution as model::TimeDelta
+    using Duration = microseconds;
+    using Task = std::function<void(Duration delta)>;
+
+    struct TaskConfig {
+        std::string name;
+        // 0 runs the task on every Advance, such a task never runs by the real time
+        Clock::duration period {0};
+        // offset of the first run, spreads the tasks with the same period
+        Clock::duration phase {0};
+        // tasks due at the same time run in ascending priority
+        int priority {0};
+        // the period may stretch up to it when the runs take the whole period
+        Clock::duration max_period {0};
+        // a run longer than it is logged, 0 logs nothing
+        Clock::duration slow_cost {0};
+        // name of the task added earlier, the task runs right after every its run instead of by its own period
+        std::string follows;
+    };
+
+    struct TaskStats {
+        std::string name;
+        model::DurationHistogram costs;
+        TickStats tick;
+    };
+
+    explicit Scheduler(Strand strand)
+        : strand_{strand} {
+    }
+
+    // tasks are added before Start or Advance, throws std::invalid_argument for an unknown follows
+    void AddTask(TaskConfig config, Task task);
+
+    void Start();
+
+    // advances the clock by delta and runs the tasks due by then, called in the strand
+    void Advance(Duration delta);
+
+    // stats of every task since the previous call
+    std::vector<TaskStats> TakeStats();
+
+    // writes TakeStats to the log, the body of the metrics task
+    void LogStats();
+
+private:
+    struct TaskState {
+        TaskConfig config;
+        Task task;
+        TickRateController controller;
+        Clock::time_point last_run;
+        model::DurationHistogram costs;
+        // the tasks following this one, in ascending priority
+        std::vector<size_t> followers;
+        // the task this one follows, its period and stats are reported for both
+        std::optional<size_t> lead;
+    };
+
+    struct Due {
+        Clock::time_point time;
+        int priority;
+        size_t task;
+
+        // the heap keeps the earliest due on top
+        bool operator<(const Due& other) const noexcept {
+            if (time != other.time) {
+                return time > other.time;
+            }
+            return priority > other.priority;
+        }
+    };
+
+    void ScheduleNext();
+
+    void OnTimer(sys::error_code ec);
+
+    // runs the tasks due by now, the clock is real or manual
+    void RunDue(Clock::time_point now, bool real_time);
+
+    Clock::duration RunTask(TaskState& state, Clock::time_point now);
+
+    // runs the task and its followers, returns the cost of all of them
+    Clock::duration RunWithFollowers(TaskState& state, Clock::time_point now, bool real_time);
+
+    Strand strand_;
+    net::steady_timer timer_{strand_};
+    std::vector<TaskState> tasks_;
+    std::priority_queue<Due> due_;
+    std::vector<Due> running_;
+    // the clock of Advance
+    Clock::time_point manual_now_ {};
+    bool manual_started_ {false};
+};
+
+}  // namespace ticker
@@ -0,0 +1,49 @@
+#pragma once
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/strand.hpp>
+#include <optional>
+#include <thread>
+
+namespace simulation {
+namespace net = boost::asio;
+
+/*
+ *  Отдельный поток симуляции, владеющий моделью игры.
+ *  Тики и обработчики запросов к API выполняются в его strand: HTTP-потоки только
+ *  ставят команды в очередь io_context симуляции и не ждут тика, а медленный тик
+ *  не задерживает чтение и запись сокетов.
+ *  Поток можно закрепить за ядром процессора, чтобы уменьшить дрожание тиков.
+ */
+class SimulationThread {
+public:
+    using Strand = net::strand<net::io_context::executor_type>;
+
+    // cpu - номер ядра, за которым закрепляется поток, без него поток не закрепляется
+    explicit SimulationThread(std::optional<unsigned> cpu = std::nullopt);
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    // executor of the commands, they run one by one in the simulation thread
+    Strand GetStrand() const {
+        return strand_;
+    }
+
+    void Start();
+
+    // runs the queued commands and joins the thread
+    void Stop();
+
+private:
+    void Pin(unsigned cpu);
+
+    net::io_context ioc_{1};
+    std::optional<net::executor_work_guard<net::io_context::executor_type>> work_;
+    Strand strand_;
+    std::optional<unsigned> cpu_;
+    std::jthread thread_;
+};
+
+}  // namespace simulation
@@ -29,7 +29,7 @@ public:
     }
 
     void Restore(application::Application& application) const {
-        model::GameSession* session = application.GetGameModel().FindGameSession(game_session_id_);
+        model::GameSession* session = application.GetGameModel().FindDogSession(game_session_id_, dog_id_);
         model::Dog* dog = session->FindDog(dog_id_);
         application.GetPlayers().Add(dog, session, player_id_);
     }
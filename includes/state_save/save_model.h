@@ -64,25 +64,27 @@ public:
         , speed_(dog.GetSpeed())
         , direction_(dog.GetDirectionType())
         , score_(dog.GetScore())
-        , bag_content_(dog.GetLoots())
-        , lifetime_(dog.GetLifetime().count())
-        , stay_time_(dog.GetStayTime().count()) {
+        // the saved times stay in milliseconds
+        , lifetime_(std::chrono::duration_cast<std::chrono::milliseconds>(dog.GetLifetime()).count())
+        , stay_time_(std::chrono::duration_cast<std::chrono::milliseconds>(dog.GetStayTime()).count()) {
+        dog.ForEachLoot([this](const model::Loot& loot) {
+            bag_content_.push_back(loot);
+        });
     }
 
-    [[nodiscard]] model::Dog Restore() {
-        model::Dog dog{name_, pos_, id_};
+    void Restore(model::GameSession& game_session) const {
+        model::Dog& dog = *game_session.RestoreDog(id_, name_, pos_);
         dog.SetSpeed(speed_);
         dog.SetDirection(direction_);
         dog.AddScore(score_);
         dog.SetLastMoveTime(std::chrono::milliseconds(lifetime_-stay_time_));
         dog.SetLifeTime(std::chrono::milliseconds(lifetime_));
 
-        std::list<model::Loot> bag_content = bag_content_;
-        for (auto it = bag_content.begin(), itn = bag_content.begin(); it != bag_content.end(); it = itn) {
-            itn = std::next(it);
-            dog.PickUpLoot(bag_content, it);
+        // a saved bag may be fuller than the capacity of the current config
+        dog.ReserveBag(bag_content_.size());
+        for (const auto& loot : bag_content_) {
+            dog.AddToBag(loot);
         }
-        return dog;
     }
 
     template <typename Archive>
@@ -106,8 +108,8 @@ private:
     model::DOG_DIRECTION direction_ {model::DOG_DIRECTION::NORTH};
     int score_ {0};
     std::list<model::Loot> bag_content_;
-    size_t stay_time_;
-    size_t lifetime_;
+    size_t stay_time_ {0};
+    size_t lifetime_ {0};
 
 };
 
@@ -121,27 +123,25 @@ public:
         : map_id_(game_session.MapId())
         , last_loot_id_(game_session.GetLastLootId())
         , last_dog_id_(game_session.GetLastDogId())
-        , loots_(game_session.GetLoots())
+        , loots_(game_session.GetLoots().begin(), game_session.GetLoots().end())
     {
         for (auto dog : game_session.GetDogs())
             dogs_repr_.push_back(DogRepr(static_cast<model::Dog&>(dog)));
     }
 
-    [[nodiscard]] model::GameSession Restore(
+    [[nodiscard]] std::unique_ptr<model::GameSession> Restore(
             const model::Map* map, 
             bool randomize_spawn_points,
-            const model::LootGeneratorConfig loot_generator_config) const 
+            const model::LootGeneratorConfig loot_generator_config,
+            uint64_t random_seed) const 
     {
-        model::GameSession game_session(map, randomize_spawn_points, loot_generator_config);
-        game_session.SetLastLootId(last_loot_id_);
-        model::GameSession::Dogs dogs;
-        for (auto dog_repr : dogs_repr_) {
-            dogs.push_back(dog_repr.Restore());
+        auto game_session = std::make_unique<model::GameSession>(map, randomize_spawn_points, loot_generator_config, random_seed);
+        for (const auto& dog_repr : dogs_repr_) {
+            dog_repr.Restore(*game_session);
         }
-        game_session.SetDogs(dogs);
-        game_session.SetLoots(loots_);
-        game_session.SetLastLootId(last_loot_id_);
-        game_session.SetLastDogId(last_dog_id_);
+        game_session->SetLoots(loots_);
+        game_session->SetLastLootId(last_loot_id_);
+        game_session->SetLastDogId(last_dog_id_);
         return game_session;
     }
 
@@ -173,8 +173,8 @@ public:
 
     explicit GameSessionsRepr(const model::Game::GameSessions& game_sessions)
     {
-        for (auto game_session : game_sessions)
-            game_sessions_repr.push_back(GameSessionRepr(game_session));
+        for (auto& game_session : game_sessions)
+            game_sessions_repr.push_back(GameSessionRepr(*game_session));
     }
 
     [[nodiscard]] model::Game::GameSessions Restore(model::Game &game) const {
@@ -185,7 +185,8 @@ public:
                 game_session_repr.Restore(
                     map, 
                     game.IsRandomizeSpawnPoints(), 
-                    game.GetLootGeneratorConfig()
+                    game.GetLootGeneratorConfig(),
+                    game.MakeSessionSeed()
                 )
             );
         }
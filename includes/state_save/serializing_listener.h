@@ -12,19 +12,17 @@ class SerializingListener {
 public:
     SerializingListener(
         std::shared_ptr<application::Application> application, 
-        const std::string& save_file, 
-        milliseconds save_period
+        const std::string& save_file
     );
 
-    void OnTick(milliseconds time_delta_ms);
+    // the body of the scheduled save task, time_since_save is the game time since the previous save
+    void PeriodicSave(model::TimeDelta time_since_save);
     void Save();
     void Load();
 
 private:
     std::shared_ptr<application::Application> application_;
     const std::string save_file_;
-    milliseconds save_period_;
-    milliseconds time_since_save_;
 };
 
 } // namespace infrastructure
\ No newline at end of file
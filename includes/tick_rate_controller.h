@@ -0,0 +1,105 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+namespace ticker {
+
+// Показатели планировщика тиков за последнее окно наблюдения
+struct TickStats {
+    // ticks per second
+    double tick_rate {0};
+    uint64_t overruns {0};
+    // how late the last tick started after its deadline
+    std::chrono::steady_clock::duration lag {0};
+    std::chrono::steady_clock::duration period {0};
+};
+
+/*
+ *  Планировщик тиков с фиксированной частотой.
+ *  Следующий срок отсчитывается от предыдущего срока, а не от конца тика, поэтому стоимость
+ *  тика не удлиняет период. Тик, который начался позже срока на период или длился дольше периода,
+ *  считается перегрузкой; пропущенные сроки не догоняются, игра получает реально прошедшее время.
+ *  Если max_period больше period, период увеличивается при загрузке потока выше HIGH_LOAD
+ *  и возвращается к period, когда загрузка падает ниже LOW_LOAD.
+ */
+class TickRateController {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr double HIGH_LOAD = 0.9;
+    static constexpr double LOW_LOAD = 0.5;
+
+    TickRateController(Clock::duration period, Clock::duration max_period = Clock::duration{0})
+        : min_period_{period}
+        , max_period_{std::max(period, max_period)}
+        , period_{period} {
+    }
+
+    Clock::duration GetPeriod() const noexcept {
+        return period_;
+    }
+
+    // deadline of the first tick
+    Clock::time_point Start(Clock::time_point now) noexcept {
+        window_start_ = now;
+        return now + period_;
+    }
+
+    /*
+     * Учитывает тик, начавшийся в start для срока deadline и занявший cost,
+     * и возвращает срок следующего тика.
+     */
+    Clock::time_point OnTick(Clock::time_point deadline, Clock::time_point start, Clock::duration cost) noexcept {
+        ++window_ticks_;
+        lag_ = std::max(start - deadline, Clock::duration{0});
+        if (lag_ >= period_ || cost > period_) {
+            ++overruns_;
+        }
+
+        // smoothed share of the period spent in the ticks
+        const double load = std::chrono::duration<double>(cost) / std::chrono::duration<double>(period_);
+        load_ = load_ * 0.75 + load * 0.25;
+        if (load_ > HIGH_LOAD && period_ < max_period_) {
+            period_ = std::min(max_period_, period_ * 5 / 4);
+        }
+        else if (load_ < LOW_LOAD && period_ > min_period_) {
+            period_ = std::max(min_period_, period_ * 4 / 5);
+        }
+
+        // drift compensation: the next deadline follows the previous one,
+        // the deadlines that have passed already are skipped
+        const auto now = start + cost;
+        auto next = deadline + period_;
+        if (next < now) {
+            next = now;
+        }
+        return next;
+    }
+
+    // stats since the previous call
+    TickStats TakeStats(Clock::time_point now) noexcept {
+        TickStats stats;
+        const double window = std::chrono::duration<double>(now - window_start_).count();
+        stats.tick_rate = window > 0 ? static_cast<double>(window_ticks_) / window : 0;
+        stats.overruns = overruns_;
+        stats.lag = lag_;
+        stats.period = period_;
+        window_start_ = now;
+        window_ticks_ = 0;
+        overruns_ = 0;
+        return stats;
+    }
+
+private:
+    Clock::duration min_period_;
+    Clock::duration max_period_;
+    Clock::duration period_;
+    double load_ {0};
+    Clock::duration lag_ {0};
+    uint64_t overruns_ {0};
+    uint64_t window_ticks_ {0};
+    Clock::time_point window_start_;
+};
+
+}  // namespace ticker
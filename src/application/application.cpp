@@ -24,6 +24,56 @@ std::string SerializeMessageCode(const std::string& code, const std::string& mes
     return boost::json::serialize(response);
 }
 
+namespace {
+
+// token of the authorization header, nullopt with the error response otherwise
+std::optional<gameplay::Token> ParseAuthToken(const std::string& auth_message, APPLICATION_ERROR& app_error, std::string& app_error_msg) {
+    auto auth_token = check_token(auth_message);
+    if (!auth_token) {
+        app_error = APPLICATION_ERROR::INVALID_TOKEN;
+        app_error_msg = SerializeMessageCode("invalidToken", "Authorization header is missing");
+        return std::nullopt;
+    }
+    return gameplay::Token{*auth_token};
+}
+
+void SetUnknownToken(APPLICATION_ERROR& app_error, std::string& app_error_msg) {
+    app_error = APPLICATION_ERROR::UNKNOWN_TOKEN;
+    app_error_msg = SerializeMessageCode("unknownToken", "Player token has not been found");
+}
+
+// the player of the authorization header in the published state, nullptr with the error response otherwise
+const PublishedState::PlayerEntry* FindPublishedPlayer(const PublishedState* published_state, const std::string& auth_message,
+                                                       APPLICATION_ERROR& app_error, std::string& app_error_msg) {
+    auto token = ParseAuthToken(auth_message, app_error, app_error_msg);
+    if (!token) {
+        return nullptr;
+    }
+    auto player = published_state ? published_state->FindPlayer(*token) : nullptr;
+    if (player == nullptr) {
+        SetUnknownToken(app_error, app_error_msg);
+    }
+    return player;
+}
+
+// the "move" of the action request body, nullopt with the error response otherwise
+std::optional<std::string> ParseMoveCommand(const std::string& jsonBody, APPLICATION_ERROR& app_error, std::string& app_error_msg) {
+    boost::system::error_code ec;
+    auto value = boost::json::parse(jsonBody, ec);
+    const boost::json::value* move = nullptr;
+    if (!ec && value.is_object()) {
+        move = value.as_object().if_contains("move");
+    }
+    if (move == nullptr || !move->is_string()) {
+        app_error = APPLICATION_ERROR::INVALID_ARGUMENT;
+        app_error_msg = SerializeMessageCode("invalidArgument", "Failed to parse action");
+        return std::nullopt;
+    }
+    return std::string{move->as_string()};
+}
+
+}  // namespace
+
 std::string Application::GetRecords(unsigned start, unsigned max_items, APPLICATION_ERROR& app_error) {
     const auto json_get_records_error = [&](APPLICATION_ERROR& app_error) {
         app_error = APPLICATION_ERROR::INVALID_ARGUMENT;
@@ -86,7 +136,7 @@ std::string Application::GetMapJson(const std::string& request_target, http::sta
     }
 }
 
-std::string Application::Tick(const std::string& jsonBody, APPLICATION_ERROR& app_error) {
+std::string Application::Tick(const std::string& jsonBody, APPLICATION_ERROR& app_error, const AdvanceTime& advance_time) {
 
     const auto json_parsing_error = [&](APPLICATION_ERROR& app_error) {
         app_error = APPLICATION_ERROR::INVALID_ARGUMENT;
@@ -125,41 +175,47 @@ std::string Application::Tick(const std::string& jsonBody, APPLICATION_ERROR& ap
     }
 
     // set timeDelta
-    game_.Tick(time_delta);
+    advance_time(std::chrono::milliseconds(time_delta));
 
     app_error = APPLICATION_ERROR::APPLICATION_NO_ERROR;
     return boost::json::serialize(boost::json::object{});
 }
 
 std::string Application::ActionPlayer(const std::string& auth_message, APPLICATION_ERROR& app_error, const std::string& jsonBody) {  
-
-    const auto json_parsing_error = [&](APPLICATION_ERROR& app_error) {
-        app_error = APPLICATION_ERROR::INVALID_ARGUMENT;
-        return SerializeMessageCode("invalidArgument", "Failed to parse action");
-    };
-
-    // check valid json     
-    boost::system::error_code ec;
-    auto value = boost::json::parse(jsonBody, ec);
-    if(ec) {
-        return json_parsing_error(app_error);
+    std::string app_error_msg;
+    auto command = ParseMoveCommand(jsonBody, app_error, app_error_msg);
+    if (!command) {
+        return app_error_msg;
     }
 
-    // parsing move command from json
-    if (!value.as_object().if_contains("move")) {
-        return json_parsing_error(app_error);
+    auto player = GetPlayerFromToken(auth_message, app_error, app_error_msg);
+    if (player == nullptr) {
+        return app_error_msg;
     }
-    std::string command = value.at("move").as_string().c_str();
 
+    // move player (dog), with the tick API the time stands still, so the readers see the action at once
+    player->Move(*command);
+    PublishState();
+
+    app_error = APPLICATION_ERROR::APPLICATION_NO_ERROR;
+    return boost::json::serialize(boost::json::object{});     
+}
+
+std::string Application::QueueActionPlayer(const std::string& auth_message, APPLICATION_ERROR& app_error, const std::string& jsonBody) {
     std::string app_error_msg;
-    auto player = GetPlayerFromToken(auth_message, app_error, app_error_msg);
+    auto command = ParseMoveCommand(jsonBody, app_error, app_error_msg);
+    if (!command) {
+        return app_error_msg;
+    }
 
+    auto published_state = published_state_.load(std::memory_order_acquire);
+    auto player = FindPublishedPlayer(published_state.get(), auth_message, app_error, app_error_msg);
     if (player == nullptr) {
         return app_error_msg;
     }
 
-    // move player (dog)
-    player->Move(command);
+    // move player (dog) on the next tick
+    player->moves->Push(model::DogAction{player->dog_id, gameplay::ParseMove(*command)});
 
     app_error = APPLICATION_ERROR::APPLICATION_NO_ERROR;
     return boost::json::serialize(boost::json::object{});     
@@ -167,25 +223,38 @@ std::string Application::ActionPlayer(const std::string& auth_message, APPLICATI
 
 gameplay::Player* Application::GetPlayerFromToken(const std::string& auth_message, APPLICATION_ERROR& app_error, std::string& app_error_msg) {
     // check token format
-    auto auth_token = check_token(auth_message);
-    if (!auth_token) {
-        app_error = APPLICATION_ERROR::INVALID_TOKEN;
-        app_error_msg = SerializeMessageCode("invalidToken", "Authorization header is missing");
+    auto token = ParseAuthToken(auth_message, app_error, app_error_msg);
+    if (!token) {
         return nullptr;
     }
 
     // authorize token
-    gameplay::Token token{ *auth_token };
-    auto player = player_tokens_.FindPlayer(token);
+    auto player = player_tokens_.FindPlayer(*token);
     if (player == nullptr) {
-        app_error = APPLICATION_ERROR::UNKNOWN_TOKEN;
-        app_error_msg = SerializeMessageCode("unknownToken", "Player token has not been found");
+        SetUnknownToken(app_error, app_error_msg);
     }
     return player;
 }
 
 std::string Application::GetState(const std::string& auth_message, APPLICATION_ERROR& app_error)
 {
+    auto published_state = published_state_.load(std::memory_order_acquire);
+    std::string app_error_msg;
+    auto player = FindPublishedPlayer(published_state.get(), auth_message, app_error, app_error_msg);
+    if (player == nullptr) {
+        return app_error_msg;
+    }
+    auto session = published_state->sessions->find(player->session_id);
+    if (session == published_state->sessions->end()) {
+        SetUnknownToken(app_error, app_error_msg);
+        return app_error_msg;
+    }
+
+    app_error = APPLICATION_ERROR::APPLICATION_NO_ERROR;
+    return *session->second.state;
+}
+
+std::string Application::SerializeSessionState(const model::GameSession& session) {
     auto get_json_array = [](const auto &x, const auto &y) {
         boost::json::array json_array;
         json_array.emplace_back(x);
@@ -193,16 +262,8 @@ std::string Application::GetState(const std::string& auth_message, APPLICATION_E
         return json_array;
     };
 
-    std::string app_error_msg;
-    auto player = GetPlayerFromToken(auth_message, app_error, app_error_msg);
-
-    if (player == nullptr) {
-        return app_error_msg;
-    }
-
     boost::json::object state;
-    auto session = player->GetSession();
-    auto dogs = session->GetDogs();
+    const auto& dogs = session.GetDogs();
     for (auto& dog : dogs) {
         boost::json::object dog_param;
         dog_param["pos"] = get_json_array(dog.GetCoordinate().x, dog.GetCoordinate().y);
@@ -218,7 +279,7 @@ std::string Application::GetState(const std::string& auth_message, APPLICATION_E
     players["players"] = state;
 
     boost::json::object loot_state;
-    auto loots = session->GetLoots();
+    const auto& loots = session.GetLoots();
     auto loot_id = 0;
     for (auto& loot : loots) {
         boost::json::object loot_param;
@@ -230,10 +291,103 @@ std::string Application::GetState(const std::string& auth_message, APPLICATION_E
     // serialize response loots
     players["lostObjects"] = loot_state;
 
-    app_error = APPLICATION_ERROR::APPLICATION_NO_ERROR;
     return boost::json::serialize(players);
 }
 
+const PublishedState::PlayerEntry* PublishedState::FindPlayer(const gameplay::Token& token) const {
+    if (auto it = token_to_player->find(token); it != token_to_player->end()) {
+        return &it->second;
+    }
+    if (joined) {
+        if (auto it = joined->find(token); it != joined->end()) {
+            return &it->second;
+        }
+    }
+    return nullptr;
+}
+
+PublishedState::PlayerEntry Application::MakePlayerEntry(gameplay::Player& player) {
+    return PublishedState::PlayerEntry{
+        player.GetSession()->GetId(), 
+        player.GetDog()->GetId(), 
+        player.GetSession()->GetMoveQueue()
+    };
+}
+
+void Application::PublishState() {
+    auto previous = published_state_.load(std::memory_order_relaxed);
+    auto published_state = std::make_shared<PublishedState>();
+
+    if (players_changed_ || !previous) {
+        // the joined players are folded in here
+        auto token_to_player = std::make_shared<PublishedState::TokenToPlayer>();
+        for (const auto& [token, player] : player_tokens_.GetTokens()) {
+            token_to_player->emplace(token, MakePlayerEntry(*player));
+        }
+        published_state->token_to_player = std::move(token_to_player);
+        published_state->players = std::make_shared<const std::string>(SerializePlayers());
+        players_changed_ = false;
+    }
+    else {
+        published_state->token_to_player = previous->token_to_player;
+        published_state->joined = previous->joined;
+        published_state->players = previous->players;
+    }
+
+    // a session without changes since the previous publication shares its serialized state
+    auto sessions = std::make_shared<PublishedState::Sessions>();
+    for (const auto& game_session : game_.GetGameSessions()) {
+        const auto version = game_session->GetVersion();
+        if (previous) {
+            if (auto it = previous->sessions->find(game_session->GetId());
+                it != previous->sessions->end() && it->second.version == version) {
+                sessions->emplace(game_session->GetId(), it->second);
+                continue;
+            }
+        }
+        sessions->emplace(
+            game_session->GetId(), 
+            PublishedState::SessionState{ 
+                version, 
+                std::make_shared<const std::string>(SerializeSessionState(*game_session)) 
+            }
+        );
+    }
+    published_state->sessions = std::move(sessions);
+
+    published_state_.store(std::move(published_state), std::memory_order_release);
+}
+
+void Application::PublishJoin(const gameplay::Token& token, gameplay::Player& player) {
+    // the next publication rebuilds the players once for all the joins since the previous one
+    players_changed_ = true;
+    auto previous = published_state_.load(std::memory_order_relaxed);
+    if (!previous) {
+        PublishState();
+        return;
+    }
+
+    // the new state shares everything with the previous one but the few joined players
+    auto published_state = std::make_shared<PublishedState>(*previous);
+    auto joined = previous->joined 
+        ? std::make_shared<PublishedState::TokenToPlayer>(*previous->joined) 
+        : std::make_shared<PublishedState::TokenToPlayer>();
+    joined->emplace(token, MakePlayerEntry(player));
+    published_state->joined = std::move(joined);
+
+    // the new dog and name are visible at once, only the session of the player and the names are serialized again
+    const auto& session = *player.GetSession();
+    auto sessions = std::make_shared<PublishedState::Sessions>(*previous->sessions);
+    (*sessions)[session.GetId()] = PublishedState::SessionState{
+        session.GetVersion(),
+        std::make_shared<const std::string>(SerializeSessionState(session))
+    };
+    published_state->sessions = std::move(sessions);
+    published_state->players = std::make_shared<const std::string>(SerializePlayers());
+
+    published_state_.store(std::move(published_state), std::memory_order_release);
+}
+
 std::string Application::Join(const std::string& jsonBody, APPLICATION_ERROR& join_error) {
     
     auto invalid_argument = SerializeMessageCode("invalidArgument", "Join game error");
@@ -271,8 +425,11 @@ std::string Application::Join(const std::string& jsonBody, APPLICATION_ERROR& jo
     }
 
     auto player = GetPlayer(userName, mapId);
-    auto token = *player_tokens_.AddPlayer(player);
+    auto player_token = player_tokens_.AddPlayer(player);
+    auto token = *player_token;
     auto id = *player->GetId();
+    // the new player reads the state with the token right after the response
+    PublishJoin(player_token, *player);
 
     boost::json::object response;
     response["authToken"] = token;
@@ -283,21 +440,24 @@ std::string Application::Join(const std::string& jsonBody, APPLICATION_ERROR& jo
 }
 
 std::string Application::GetPlayers(const std::string& auth_message, APPLICATION_ERROR& auth_error) {
-    std::string app_error_msg;
-    auto player = GetPlayerFromToken(auth_message, auth_error, app_error_msg);
-
-    if (player == nullptr) {
-        return app_error_msg;
+    auto published_state = published_state_.load(std::memory_order_acquire);
+    std::string auth_error_msg;
+    if (FindPublishedPlayer(published_state.get(), auth_message, auth_error, auth_error_msg) == nullptr) {
+        return auth_error_msg;
     }
 
+    auth_error = APPLICATION_ERROR::APPLICATION_NO_ERROR;
+    return *published_state->players;
+}
+
+std::string Application::SerializePlayers() {
     boost::json::object response;
+    gameplay::Player* player = nullptr;
     for (auto palyer_id = 0; (player = players_.FindPlayer(gameplay::Player::Id{palyer_id})) != nullptr; palyer_id++) {
         boost::json::object name;
         name["name"] = player->GetName();
         response[std::to_string(palyer_id)] = name;
     }
-
-    auth_error = APPLICATION_ERROR::APPLICATION_NO_ERROR;
     return boost::json::serialize(response);
 }
 
@@ -306,6 +466,7 @@ gameplay::Player* Application::GetPlayer(const std::string& name, const std::str
     auto map_id = model::Map::Id{mapId};
     auto player_id = players_.FindPlayerId(name, map_id);
     if (player_id == nullptr) {
+        // join the least loaded session of the map, open a new one when all of them are full
         auto session = game_.FindGameSession(map_id);
         if (session == nullptr) {
             session = game_.AddGameSession(map_id);
@@ -323,16 +484,16 @@ gameplay::Player* Application::GetPlayer(const std::string& name, const std::str
 
 boost::json::array Application::GetDogLoots(const model::Dog& dog) {
     boost::json::array json_array;
-    for (const auto& loot : const_cast<model::Dog&>(dog).GetLoots()) {
+    dog.ForEachLoot([&json_array](const model::Loot& loot) {
         boost::json::object value;
         value["id"] = *loot.id;
         value["type"] = loot.type;
         json_array.emplace_back(std::move(value));
-    }
+    });
     return json_array;
 }
 
-void Application::RetirePlayers(std::chrono::milliseconds delta) {
+void Application::RetirePlayers(model::TimeDelta delta) {
     auto& players = players_.GetPlayers();
     std::vector<gameplay::Player::Id> players_to_delete;
     for (const auto& player : players) {
@@ -342,20 +503,23 @@ void Application::RetirePlayers(std::chrono::milliseconds delta) {
                 (*player).GetId(), 
                 dog->GetName(), 
                 dog->GetScore(), 
-                dog->GetLifetime() 
+                // the records keep the play time in milliseconds
+                std::chrono::duration_cast<std::chrono::milliseconds>(dog->GetLifetime())
             };
             database_.GetRetiredPlayerRepository().Save(retired_player);
             players_to_delete.push_back((*player).GetId());
         }
     }
     for (auto& player_id : players_to_delete) {
-        for (auto& session : game_.GetGameSessions()) {
-            auto dog_id = players_.FindPlayer(player_id)->GetDog()->GetId();
-            session.DeleteDog(dog_id);
-        }
+        auto player = players_.FindPlayer(player_id);
+        player->GetSession()->DeleteDog(player->GetDog()->GetId());
         player_tokens_.DeletePlayerToken(player_id);
         players_.DeletePlayer(player_id);
     }
+    // the snapshot task runs right after the retirement and publishes the players
+    if (!players_to_delete.empty()) {
+        players_changed_ = true;
+    }
 }
 
 };
\ No newline at end of file
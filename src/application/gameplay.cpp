@@ -81,29 +81,28 @@ std::optional<std::string> ModelJsonSerializer::SerializeMap(const std::string&
     return boost::json::serialize(map_object);
 }
 
-void Player::Move(const std::string& command) {
-    model::DOG_MOVE dog_move;
+model::DOG_MOVE ParseMove(const std::string& command) {
     if (command == "L") 
     {
-        dog_move = model::DOG_MOVE::LEFT;
+        return model::DOG_MOVE::LEFT;
     }
     else if (command == "R")
     {
-        dog_move = model::DOG_MOVE::RIGHT;
+        return model::DOG_MOVE::RIGHT;
     }
     else if (command == "U")
     {
-        dog_move = model::DOG_MOVE::UP;
+        return model::DOG_MOVE::UP;
     }
     else if (command == "D")
     {
-        dog_move = model::DOG_MOVE::DOWN;
-    }
-    else 
-    {
-        dog_move = model::DOG_MOVE::STAND;
+        return model::DOG_MOVE::DOWN;
     }
-    session_->MoveDog(dog_->GetId(), dog_move);    
+    return model::DOG_MOVE::STAND;
+}
+
+void Player::Move(const std::string& command) {
+    session_->MoveDog(dog_->GetId(), ParseMove(command));    
 }
 
 Player* PlayerTokens::FindPlayer(const Token& token)
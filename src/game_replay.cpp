@@ -0,0 +1,94 @@
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <optional>
+
+#include <json_loader.h>
+#include <model/game_record.h>
+
+using namespace std::literals;
+namespace po = boost::program_options;
+
+namespace {
+
+struct Args {
+    std::string config_file;
+    std::string record_file;
+    unsigned tick_threads {1};
+};
+
+[[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
+    po::options_description desc{"All options"s};
+    Args args;
+    desc.add_options()
+        ("help,h", "help message")
+        // Параметр --config-file (-c) задаёт конфигурацию игры, с которой был записан журнал
+        ("config-file,c", po::value(&args.config_file)->value_name("file"s), "game config file path")
+        // Параметр --record-file (-r) задаёт журнал, записанный сервером с параметром --record-file
+        ("record-file,r", po::value(&args.record_file)->value_name("file"s), "game record file path")
+        ("tick-threads", po::value(&args.tick_threads)->value_name("count"s), "number of threads ticking game sessions");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+    if (vm.contains("help")) {
+        std::cout << desc;
+        return std::nullopt;
+    }
+    if (!vm.contains("config-file"s)) {
+        throw std::runtime_error("Config files have not been specified");
+    }
+    if (!vm.contains("record-file"s)) {
+        throw std::runtime_error("Record file has not been specified");
+    }
+    return args;
+}
+
+}  // namespace
+
+// Воспроизводит журнал игры без сети и базы данных так быстро, как позволяет модель
+int main(int argc, const char* argv[]) {
+    try {
+        auto args = ParseCommandLine(argc, argv);
+        if (!args) {
+            return EXIT_SUCCESS;
+        }
+
+        model::Game game = json_loader::LoadGame(args->config_file);
+        game.SetTickThreads(args->tick_threads);
+
+        std::ifstream input{args->record_file, std::ios::binary};
+        if (!input) {
+            throw std::runtime_error("Can't open " + args->record_file);
+        }
+        model::GameRecordReader reader{input};
+        model::GameReplay replay{game, reader.ReadHeader()};
+
+        // the events are read in advance, so the replay measures only the model
+        std::vector<model::RecordEvent> events;
+        model::RecordEvent event;
+        while (reader.Next(event)) {
+            events.push_back(event);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& recorded : events) {
+            replay.Apply(recorded);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        const auto ticks = replay.GetTicks();
+        std::cout << "events: " << events.size() << '\n'
+                  << "ticks: " << ticks << '\n'
+                  << "game time, s: " << std::chrono::duration<double>(replay.GetGameTime()).count() << '\n'
+                  << "replay time, s: " << elapsed.count() << '\n'
+                  << "ticks per second: " << (elapsed.count() > 0 ? ticks / elapsed.count() : 0.0) << '\n'
+                  << "mean tick, us: " << (ticks > 0 ? elapsed.count() * 1e6 / ticks : 0.0) << std::endl;
+    }
+    catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
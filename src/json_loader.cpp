@@ -13,6 +13,9 @@ using namespace boost::property_tree;
 
 static constexpr size_t default_bag_capacity = 3;
 static constexpr double default_retirement_time = 60;
+static constexpr double default_session_empty_time = 60;
+// 0 - unlimited number of players in one game session
+static constexpr size_t default_session_max_players = 0;
 
 model::Road LoadRoad(const ptree &road) {
     try {
@@ -65,7 +68,7 @@ model::Office LoadOffice(const ptree& office) {
     }
 }
 
-model::Map LoadMap(const ptree& map, double defaultDogSpeed, int defaultBagCapacity) {
+model::Map LoadMap(const ptree& map, double defaultDogSpeed, int defaultBagCapacity, size_t defaultSessionMaxPlayers) {
     try {
         auto map_id = model::Map::Id(map.get<std::string>("id"));
         auto map_name = map.get<std::string>("name");
@@ -87,6 +90,9 @@ model::Map LoadMap(const ptree& map, double defaultDogSpeed, int defaultBagCapac
             model_map.SetBagCapacity(defaultBagCapacity);
         }
 
+        // check players limit of one game session on map
+        model_map.SetSessionMaxPlayers(map.get<size_t>("sessionMaxPlayers", defaultSessionMaxPlayers));
+
         auto roads = map.get_child("roads");
         for (auto road : roads) {
             model_map.AddRoad(LoadRoad(road.second));
@@ -181,9 +187,21 @@ model::Game LoadGame(const std::filesystem::path& json_path) {
         auto defaultRetirementTime = pt.get<double>("dogRetirementTime", default_retirement_time) * 1000;
         game.SetRetirementTime(defaultRetirementTime);
 
+        // check how long an empty game session is kept
+        auto sessionEmptyTime = pt.get<double>("sessionEmptyTime", default_session_empty_time) * 1000;
+        game.SetSessionEmptyTime(std::chrono::milliseconds(static_cast<int64_t>(sessionEmptyTime)));
+
+        // check seed of game sessions random generators, sessions are seeded randomly without it
+        if (auto randomSeed = pt.get_optional<uint64_t>("randomSeed")) {
+            game.SetRandomSeed(*randomSeed);
+        }
+
+        // check default players limit of one game session
+        auto defaultSessionMaxPlayers = pt.get<size_t>("defaultSessionMaxPlayers", default_session_max_players);
+
         auto maps = pt.get_child("maps");
         for (auto map : maps) {
-            game.AddMap(LoadMap(map.second, defaultDogSpeed, defaultBagCapacity));
+            game.AddMap(LoadMap(map.second, defaultDogSpeed, defaultBagCapacity, defaultSessionMaxPlayers));
         }
 
         LoadLootType(game, json_path);
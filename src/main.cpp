@@ -6,11 +6,15 @@
 #include <memory>
 #include <iostream>
 #include <thread>
+#include <fstream>
+#include <random>
 
 #include <json_loader.h>
 #include <network/request_handler.h>
 #include <logger/logger.h>
-#include <ticker.h>
+#include <scheduler.h>
+#include <simulation.h>
+#include <model/game_record.h>
 #include <application/application.h>
 #include <state_save/serializing_listener.h>
 
@@ -33,6 +37,41 @@ std::string GetDatabaseUrlFromEnv() {
     return db_url;
 }
 
+double ToMilliseconds(model::TickPhaseTimes::Clock::duration time) {
+    return std::chrono::duration<double, std::milli>(time).count();
+}
+
+// the breakdown of a slow session tick names the map and the phase behind an overrun
+void LogSlowTick(const model::SlowSessionTick& tick) {
+    boost::json::object log_data;
+    log_data["sessionId"] = tick.session_id;
+    log_data["map"] = *tick.map_id;
+    log_data["dogs"] = tick.dogs;
+    log_data["loots"] = tick.loots;
+    log_data["tickMs"] = ToMilliseconds(tick.times.Total());
+    for (size_t phase = 0; phase < model::TICK_PHASE_COUNT; ++phase) {
+        log_data[std::string{model::TICK_PHASE_NAMES[phase]} + "Ms"] = ToMilliseconds(tick.times.phases[phase]);
+    }
+    LOG().print(log_data, "slow session tick");
+}
+
+void LogTickProfile(const model::TickProfile& profile) {
+    auto log_histogram = [](std::string_view phase, const model::DurationHistogram& histogram) {
+        boost::json::object log_data;
+        log_data["phase"] = std::string{phase};
+        log_data["ticks"] = histogram.Count();
+        log_data["totalMs"] = ToMilliseconds(histogram.Total());
+        log_data["p50Ms"] = ToMilliseconds(histogram.Percentile(0.5));
+        log_data["p99Ms"] = ToMilliseconds(histogram.Percentile(0.99));
+        log_data["maxMs"] = ToMilliseconds(histogram.Max());
+        LOG().print(log_data, "session tick stats");
+    };
+    log_histogram("tick"sv, profile.ticks);
+    for (size_t phase = 0; phase < model::TICK_PHASE_COUNT; ++phase) {
+        log_histogram(model::TICK_PHASE_NAMES[phase], profile.phases[phase]);
+    }
+}
+
 // Запускает функцию fn на n потоках, включая текущий
 template <typename Fn>
 void RunWorkers(unsigned workers_count, const Fn& fn) {
@@ -51,6 +90,7 @@ void RunWorkers(unsigned workers_count, const Fn& fn) {
     // Выводим описание параметров программы
     http_handler::Args args;
     uint64_t period_serialization = 0;
+    unsigned simulation_cpu = 0;
     desc.add_options()
         // Параметр --help (-h) должен выводить информацию о параметрах командной строки.
         ("help,h", "help message")
@@ -58,6 +98,14 @@ void RunWorkers(unsigned workers_count, const Fn& fn) {
         // Если этот параметр указан, каждые N миллисекунд сервер должен обновлять координаты объектов. 
         // Если этот параметр не указан, время в игре должно управляться с помощью запроса /api/v1/game/tick к REST API
         ("tick-period,t", po::value(&args.tick_time)->value_name("milliseconds"s), "auto tick time in milliseconds")
+        // Параметр --max-tick-period разрешает увеличивать период обновления до указанного значения, когда тики не успевают
+        ("max-tick-period", po::value(&args.max_tick_time)->value_name("milliseconds"s), "max auto tick time under load in milliseconds")
+        // Параметр --slow-tick-threshold пишет в лог разбивку по фазам каждого тика сессии и каждой задачи дольше порога
+        ("slow-tick-threshold", po::value(&args.slow_tick_time)->value_name("milliseconds"s), "log the phases of ticks longer than it")
+        // Параметр --tick-threads задаёт число потоков, на которых параллельно обновляются игровые сессии
+        ("tick-threads", po::value(&args.tick_threads)->value_name("count"s), "number of threads ticking game sessions")
+        // Параметр --simulation-cpu закрепляет поток симуляции за ядром процессора
+        ("simulation-cpu", po::value(&simulation_cpu)->value_name("cpu"s), "pin the simulation thread to the cpu")
         // Параметр --config-file (-c) задаёт путь к конфигурационному JSON-файлу игры.
         ("config-file,c", po::value(&args.config_file)->value_name("file"s), "game config file path")
         // Параметр --www-root (-w) задаёт путь к каталогу со статическими файлами игры.
@@ -67,7 +115,9 @@ void RunWorkers(unsigned workers_count, const Fn& fn) {
         // Параметр --state-file задает имя файла для сохранения в нем состояния игры.
         ("state-file", po::value(&args.save_file)->value_name("file"s), "save state file path")
         // Параметр --save-state-period задает с какой переодичностью проводить сохранение состояния игры
-        ("save-state-period", po::value(&period_serialization)->value_name("milliseconds"s), "set save period (serialization)");
+        ("save-state-period", po::value(&period_serialization)->value_name("milliseconds"s), "set save period (serialization)")
+        // Параметр --record-file записывает операции над игрой в файл для воспроизведения программой game_replay
+        ("record-file", po::value(&args.record_file)->value_name("file"s), "record the game for game_replay");
     
     // variables_map хранит значения опций после разбора
     po::variables_map vm;
@@ -92,6 +142,9 @@ void RunWorkers(unsigned workers_count, const Fn& fn) {
     if (!vm.contains("www-root"s)) {
         throw std::runtime_error("Static file path is not specified");
     }
+    if (vm.contains("simulation-cpu"s)) {
+        args.simulation_cpu = simulation_cpu;
+    }
     if (vm.contains("randomize-spawn-points")) {
         args.randomize_spawn_points = true;
     }
@@ -130,10 +183,11 @@ int main(int argc, const char* argv[]) {
         // 1. Загружаем карту из файла и построить модель игры
         model::Game game = json_loader::LoadGame(args.config_file);
         game.SetRandomizeSpawnPoints(args.randomize_spawn_points);    
+        game.SetTickThreads(args.tick_threads);
 
         // 2. Добавляем application_saver
         args.application = std::make_shared<application::Application>(game, std::thread::hardware_concurrency(), GetDatabaseUrlFromEnv());
-        auto application_saver = serializing_listener::SerializingListener(args.application, args.save_file, args.save_state_period);
+        auto application_saver = serializing_listener::SerializingListener(args.application, args.save_file);
         try {
             if (!args.save_file.empty()) {
                 application_saver.Load();        
@@ -144,16 +198,25 @@ int main(int argc, const char* argv[]) {
             throw ex;
         }
 
-        if (args.save_state && 
-            args.save_state_period != std::chrono::milliseconds{0}) 
-        {
-            auto do_on_tick_handler = game.DoOnTickSlot(
-                [&application_saver, &args] (std::chrono::milliseconds delta) mutable {
-                    application_saver.OnTick(delta);
-                    args.application->RetirePlayers(delta);
-                }
-            );
-        } 
+        // Журнал игры начинается с пустой игры, без зерна в конфигурации оно выбирается здесь
+        std::ofstream record_output;
+        std::optional<model::GameRecorder> recorder;
+        if (!args.record_file.empty()) {
+            // dogs restored from the state file have no joins in the record, their actions couldn't be recorded
+            if (!game.GetGameSessions().empty()) {
+                throw std::runtime_error("--record-file can't be used with the game sessions restored from --state-file " + args.save_file);
+            }
+            if (!game.GetRandomSeed()) {
+                std::random_device random_device;
+                game.SetRandomSeed((static_cast<uint64_t>(random_device()) << 32) | random_device());
+            }
+            record_output.open(args.record_file, std::ios::binary);
+            if (!record_output) {
+                throw std::runtime_error("Can't open record file " + args.record_file);
+            }
+            recorder.emplace(record_output);
+            game.SetRecorder(&*recorder);
+        }
 
         // 3. Инициализируем io_context
         const unsigned num_threads = std::thread::hardware_concurrency();
@@ -169,29 +232,60 @@ int main(int argc, const char* argv[]) {
             }
         });
 
-        // strand для выполнения запросов к API
-        auto api_strand = net::make_strand(ioc);
-        // 5. Создаём обработчик HTTP-запросов и связываем его с моделью игры
-        http_handler::RequestHandler handler{game, args, api_strand};
-        http_handler::LoggingRequestHandler logging_handler{handler};
+        // Модель игры принадлежит потоку симуляции: тики и запросы к API выполняются в его strand,
+        // потоки ioc только читают и пишут сокеты
+        simulation::SimulationThread simulation(args.simulation_cpu);
+        auto api_strand = simulation.GetStrand();
 
-        // 6. Настраиваем вызов метода Game::Tick каждые tick_time миллисекунд внутри api_strand
-        auto ticker = std::make_shared<ticker::Ticker>( api_strand,
-                                                        args.tick_time,
-                                                        [&game](uint64_t delta) { 
-                                                            game.Tick(delta); 
-                                                        }
+        // 5. Регистрируем периодические задачи потока симуляции. С запросом /api/v1/game/tick
+        // задачи с периодом тика выполняются на каждый запрос, остальные - по игровому времени
+        args.scheduler = std::make_shared<ticker::Scheduler>(api_strand);
+        const auto tick_period = args.use_tick_api ? 0ms : std::chrono::milliseconds{args.tick_time};
+        const auto max_tick_period = args.use_tick_api ? 0ms : std::chrono::milliseconds{args.max_tick_time};
+        const auto slow_tick = std::chrono::milliseconds{args.slow_tick_time};
+        if (slow_tick != 0ms) {
+            game.SetSlowTickHandler(slow_tick, LogSlowTick);
+        }
+        args.scheduler->AddTask(
+            {.name = "simulation"s, .period = tick_period, .priority = 0, .max_period = max_tick_period, .slow_cost = slow_tick},
+            [&game](ticker::Scheduler::Duration delta) {
+                game.Tick(delta);
+            }
         );
-
-        // Настраиваем вызов метода Application::RetirePlayers каждые delta миллисекунд внутри api_strand
-        auto ticker_retire = std::make_shared<ticker::Ticker>(
-            api_strand, 
-            args.tick_time,
-            [&args](uint64_t delta) { 
-                args.application->RetirePlayers(std::chrono::milliseconds(delta)); 
+        // retirement and the snapshot run right after every tick and stretch with its period,
+        // readers get the sessions and the retired players right after the tick
+        args.scheduler->AddTask(
+            {.name = "retirement"s, .priority = 1, .slow_cost = slow_tick, .follows = "simulation"s},
+            [&args](ticker::Scheduler::Duration delta) {
+                args.application->RetirePlayers(delta);
+            }
+        );
+        args.scheduler->AddTask(
+            {.name = "snapshot"s, .priority = 2, .slow_cost = slow_tick, .follows = "simulation"s},
+            [&args](ticker::Scheduler::Duration) {
+                args.application->PublishState();
+            }
+        );
+        if (args.save_state && args.save_state_period != 0ms) {
+            args.scheduler->AddTask(
+                {.name = "save"s, .period = args.save_state_period, .priority = 3, .slow_cost = slow_tick},
+                [&application_saver](ticker::Scheduler::Duration delta) {
+                    application_saver.PeriodicSave(delta);
+                }
+            );
+        }
+        args.scheduler->AddTask(
+            {.name = "metrics"s, .period = 10s, .priority = 4},
+            [scheduler = args.scheduler.get(), &game](ticker::Scheduler::Duration) {
+                scheduler->LogStats();
+                LogTickProfile(game.TakeTickProfile());
             }
         );
 
+        // 6. Создаём обработчик HTTP-запросов и связываем его с моделью игры
+        http_handler::RequestHandler handler{game, args, api_strand};
+        http_handler::LoggingRequestHandler logging_handler{handler};
+
         // 7. Запустить обработчик HTTP-запросов, делегируя их обработчику запросов
         const auto address = net::ip::make_address("0.0.0.0");
         constexpr net::ip::port_type port = 8080;
@@ -201,9 +295,11 @@ int main(int argc, const char* argv[]) {
                 std::forward<decltype(send)>(send), 
                 socket);
         });
-        // 8. Запустить ticker и ticker_retire
-        ticker->Start();
-        ticker_retire->Start();
+        // 8. Запустить поток симуляции и планировщик
+        simulation.Start();
+        if (!args.use_tick_api) {
+            args.scheduler->Start();
+        }
 
         // 9. Эта надпись сообщает тестам о том, что сервер запущен и готов обрабатывать запросы
         LOG_MSG().server_start(address.to_string(), port);
@@ -212,6 +308,11 @@ int main(int argc, const char* argv[]) {
         RunWorkers(std::max(1u, num_threads), [&ioc] {
             ioc.run();
         });
+        // после остановки потока симуляции модель больше никто не изменяет
+        simulation.Stop();
+        if (recorder) {
+            recorder->Flush();
+        }
 
         // В этой точке все асинхронные операции уже завершены и можно 
         // сохранить состояние сервера в файл
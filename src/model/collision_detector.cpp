@@ -1,8 +1,14 @@
 #include "collision_detector.h"
 #include <cassert>
+#include <cmath>
 #include <algorithm>
 #include <vector>
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define COLLISION_DETECTOR_AVX2
+#include <immintrin.h>
+#endif
+
 namespace collision_detector {
 
 CollectionResult TryCollectPoint(geom::Point2D a, geom::Point2D b, geom::Point2D c) {
@@ -25,46 +31,366 @@ CollectionResult TryCollectPoint(geom::Point2D a, geom::Point2D b, geom::Point2D
 }
 
 
-std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider) {
-    std::vector<GatheringEvent> gather_events;
+namespace {
 
-    auto equal_positions = [](geom::Point2D p1, geom::Point2D p2) {
-        return p1.x == p2.x && p1.y == p2.y;
-    };
+// the same arithmetic as TryCollectPoint, so both give bit-identical results
+void CollectPointsScalar(geom::Point2D a, geom::Point2D b, double gatherer_width,
+                         const double* xs, const double* ys, const double* widths,
+                         size_t first, size_t count, std::vector<CollectHit>& hits) {
+    const double v_x = b.x - a.x;
+    const double v_y = b.y - a.y;
+    const double v_len2 = v_x * v_x + v_y * v_y;
+    for (size_t i = first; i < count; ++i) {
+        const double u_x = xs[i] - a.x;
+        const double u_y = ys[i] - a.y;
+        const double u_dot_v = u_x * v_x + u_y * v_y;
+        const double u_len2 = u_x * u_x + u_y * u_y;
+        const double proj_ratio = u_dot_v / v_len2;
+        const double sq_distance = u_len2 - (u_dot_v * u_dot_v) / v_len2;
+        const double radius = gatherer_width + widths[i];
+        if (proj_ratio >= 0 && proj_ratio <= 1 && sq_distance <= radius * radius) {
+            hits.push_back(CollectHit{i, sq_distance, proj_ratio});
+        }
+    }
+}
+
+#ifdef COLLISION_DETECTOR_AVX2
+// no FMA here: fused multiply-add would round differently from TryCollectPoint
+__attribute__((target("avx2")))
+void CollectPointsAvx2(geom::Point2D a, geom::Point2D b, double gatherer_width,
+                       const double* xs, const double* ys, const double* widths,
+                       size_t count, std::vector<CollectHit>& hits) {
+    const __m256d a_x = _mm256_set1_pd(a.x);
+    const __m256d a_y = _mm256_set1_pd(a.y);
+    const double v_x_scalar = b.x - a.x;
+    const double v_y_scalar = b.y - a.y;
+    const __m256d v_x = _mm256_set1_pd(v_x_scalar);
+    const __m256d v_y = _mm256_set1_pd(v_y_scalar);
+    const __m256d v_len2 = _mm256_set1_pd(v_x_scalar * v_x_scalar + v_y_scalar * v_y_scalar);
+    const __m256d width = _mm256_set1_pd(gatherer_width);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
 
-    for (auto gatherer_id = 0; gatherer_id < provider.GatherersCount(); ++gatherer_id) {
-        auto gatherer = provider.GetGatherer(gatherer_id);
-        
-        // check gatherer start == end
-        if (equal_positions(gatherer.start_pos, gatherer.end_pos)) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256d u_x = _mm256_sub_pd(_mm256_loadu_pd(xs + i), a_x);
+        const __m256d u_y = _mm256_sub_pd(_mm256_loadu_pd(ys + i), a_y);
+        const __m256d u_dot_v = _mm256_add_pd(_mm256_mul_pd(u_x, v_x), _mm256_mul_pd(u_y, v_y));
+        const __m256d u_len2 = _mm256_add_pd(_mm256_mul_pd(u_x, u_x), _mm256_mul_pd(u_y, u_y));
+        const __m256d proj_ratio = _mm256_div_pd(u_dot_v, v_len2);
+        const __m256d sq_distance = _mm256_sub_pd(u_len2, _mm256_div_pd(_mm256_mul_pd(u_dot_v, u_dot_v), v_len2));
+        const __m256d radius = _mm256_add_pd(width, _mm256_loadu_pd(widths + i));
+        const __m256d collected = _mm256_and_pd(
+            _mm256_and_pd(_mm256_cmp_pd(proj_ratio, zero, _CMP_GE_OQ), _mm256_cmp_pd(proj_ratio, one, _CMP_LE_OQ)),
+            _mm256_cmp_pd(sq_distance, _mm256_mul_pd(radius, radius), _CMP_LE_OQ)
+        );
+        int mask = _mm256_movemask_pd(collected);
+        if (mask == 0) {
             continue;
         }
-        for (auto item_id = 0; item_id < provider.ItemsCount(); ++item_id) {
-            auto item = provider.GetItem(item_id);
-            auto collect_result = TryCollectPoint(gatherer.start_pos, gatherer.end_pos, item.position);
-
-            if (collect_result.IsCollected(gatherer.width + item.width)) {
-                GatheringEvent gather_event { 
-                    .item_id = item_id,
-                    .gatherer_id = gatherer_id,
-                    .sq_distance = collect_result.sq_distance,
-                    .time = collect_result.proj_ratio
-                };
-                gather_events.push_back(gather_event);
-            }
+        alignas(32) double proj_lanes[4];
+        alignas(32) double sq_lanes[4];
+        _mm256_store_pd(proj_lanes, proj_ratio);
+        _mm256_store_pd(sq_lanes, sq_distance);
+        for (; mask != 0; mask &= mask - 1) {
+            const int lane = __builtin_ctz(mask);
+            hits.push_back(CollectHit{i + lane, sq_lanes[lane], proj_lanes[lane]});
+        }
+    }
+    CollectPointsScalar(a, b, gatherer_width, xs, ys, widths, i, count, hits);
+}
+
+bool HasAvx2() {
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+}
+#endif
+
+}  // namespace
+
+void CollectPoints(geom::Point2D a, geom::Point2D b, double gatherer_width,
+                   const double* xs, const double* ys, const double* widths, size_t count,
+                   std::vector<CollectHit>& hits) {
+    assert(b.x != a.x || b.y != a.y);
+#ifdef COLLISION_DETECTOR_AVX2
+    if (HasAvx2()) {
+        CollectPointsAvx2(a, b, gatherer_width, xs, ys, widths, count, hits);
+        return;
+    }
+#endif
+    CollectPointsScalar(a, b, gatherer_width, xs, ys, widths, 0, count, hits);
+}
+
+namespace {
+
+// below this number of gatherer-item pairs the plain scan is cheaper than the grid
+constexpr size_t BROADPHASE_MIN_PAIRS = 256;
+
+// extra reach of the query box, covers rounding errors of TryCollectPoint
+constexpr double BROADPHASE_MARGIN = 1e-6;
+
+bool IsStanding(const Gatherer& gatherer) {
+    return gatherer.start_pos.x == gatherer.end_pos.x && gatherer.start_pos.y == gatherer.end_pos.y;
+}
+
+// items as a structure of arrays, the layout CollectPoints works on
+struct ItemsBlock {
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> width;
+
+    void Clear() {
+        x.clear();
+        y.clear();
+        width.clear();
+    }
+
+    void Add(const Item& item) {
+        x.push_back(item.position.x);
+        y.push_back(item.position.y);
+        width.push_back(item.width);
+    }
+
+    // appends the hits of [first, last), hit.index is the position in the block
+    void Collect(const Gatherer& gatherer, size_t first, size_t last, std::vector<CollectHit>& hits) const {
+        const size_t begin = hits.size();
+        CollectPoints(gatherer.start_pos, gatherer.end_pos, gatherer.width,
+                      x.data() + first, y.data() + first, width.data() + first, last - first, hits);
+        for (size_t i = begin; i < hits.size(); ++i) {
+            hits[i].index += first;
+        }
+    }
+};
+
+/*
+ * Uniform grid over item positions.
+ * Items are stored ordered by cell, the items of cell c are [cell_start_[c], cell_start_[c + 1]),
+ * so every row of a query box is one contiguous block for CollectPoints.
+ * The cell size is chosen so that a cell holds about one item.
+ */
+class ItemGrid {
+public:
+    // buffers keep their capacity between builds
+    void Build(std::span<const Item> items) {
+        max_item_width_ = 0;
+        min_x_ = max_x_ = items.front().position.x;
+        min_y_ = max_y_ = items.front().position.y;
+        for (const auto& item : items) {
+            min_x_ = std::min(min_x_, item.position.x);
+            max_x_ = std::max(max_x_, item.position.x);
+            min_y_ = std::min(min_y_, item.position.y);
+            max_y_ = std::max(max_y_, item.position.y);
+            max_item_width_ = std::max(max_item_width_, item.width);
+        }
+
+        const double width = max_x_ - min_x_;
+        const double height = max_y_ - min_y_;
+        const double count = static_cast<double>(items.size());
+        cell_size_ = width * height > 0 ? std::sqrt(width * height / count) : std::max(width, height) / count;
+        // a long thin box would get too many cells along its long side
+        cell_size_ = std::max(cell_size_, std::max(width, height) / (2 * count));
+        if (!(cell_size_ > 0)) {
+            cell_size_ = 1.0;
+        }
+        columns_ = CellsAlong(width);
+        rows_ = CellsAlong(height);
+
+        // counting sort of items by cell
+        cell_start_.assign(columns_ * rows_ + 1, 0);
+        for (const auto& item : items) {
+            ++cell_start_[CellOf(item.position) + 1];
+        }
+        for (size_t cell = 1; cell < cell_start_.size(); ++cell) {
+            cell_start_[cell] += cell_start_[cell - 1];
+        }
+        ids_.resize(items.size());
+        fill_.assign(cell_start_.begin(), cell_start_.end() - 1);
+        for (size_t item_id = 0; item_id < items.size(); ++item_id) {
+            ids_[fill_[CellOf(items[item_id].position)]++] = item_id;
+        }
+        block_.Clear();
+        for (auto item_id : ids_) {
+            block_.Add(items[item_id]);
+        }
+    }
+
+    double GetMaxItemWidth() const noexcept {
+        return max_item_width_;
+    }
+
+    // hits of the gatherer among the items inside the box, hit.index is the item id, ascending
+    void Collect(const Gatherer& gatherer, double x0, double y0, double x1, double y1,
+                 std::vector<CollectHit>& hits) const {
+        hits.clear();
+        if (x1 < min_x_ || x0 > max_x_ || y1 < min_y_ || y0 > max_y_) {
+            return;
+        }
+        const size_t column0 = Column(x0);
+        const size_t column1 = Column(x1);
+        const size_t row0 = Row(y0);
+        const size_t row1 = Row(y1);
+        for (size_t row = row0; row <= row1; ++row) {
+            block_.Collect(gatherer, cell_start_[row * columns_ + column0], cell_start_[row * columns_ + column1 + 1], hits);
+        }
+        for (auto& hit : hits) {
+            hit.index = ids_[hit.index];
+        }
+        std::sort(hits.begin(), hits.end(), [](const CollectHit& l, const CollectHit& r) {
+            return l.index < r.index;
+        });
+    }
+
+private:
+    size_t CellsAlong(double extent) const {
+        return static_cast<size_t>(extent / cell_size_) + 1;
+    }
+
+    size_t Index(double offset, size_t cells) const {
+        if (!(offset > 0)) {
+            return 0;
         }
+        return std::min(static_cast<size_t>(offset / cell_size_), cells - 1);
     }
 
+    size_t Column(double x) const {
+        return Index(x - min_x_, columns_);
+    }
+
+    size_t Row(double y) const {
+        return Index(y - min_y_, rows_);
+    }
+
+    size_t CellOf(geom::Point2D position) const {
+        return Row(position.y) * columns_ + Column(position.x);
+    }
+
+    double min_x_;
+    double max_x_;
+    double min_y_;
+    double max_y_;
+    double max_item_width_ {0};
+    double cell_size_;
+    size_t columns_;
+    size_t rows_;
+    std::vector<size_t> cell_start_;
+    std::vector<size_t> fill_;
+    // items ordered by cell and their ids
+    ItemsBlock block_;
+    std::vector<size_t> ids_;
+};
+
+}  // namespace
+
+struct GatherScratch::Buffers {
+    ItemsBlock block;
+    ItemGrid grid;
+    std::vector<CollectHit> hits;
+    std::chrono::steady_clock::duration broadphase_time {0};
+};
+
+GatherScratch::GatherScratch() : buffers_(std::make_unique<Buffers>()) {}
+
+GatherScratch::~GatherScratch() = default;
+
+GatherScratch::GatherScratch(GatherScratch&&) noexcept = default;
+
+GatherScratch& GatherScratch::operator=(GatherScratch&&) noexcept = default;
+
+std::chrono::steady_clock::duration GatherScratch::GetBroadphaseTime() const noexcept {
+    return buffers_->broadphase_time;
+}
+
+void SortGatherEvents(std::vector<GatheringEvent>& gather_events) {
     std::sort(
         gather_events.begin(), 
         gather_events.end(),
         [] (const GatheringEvent& event1, const GatheringEvent& event2) {
+            if (event1.time != event2.time) {
                 return event1.time < event2.time;
+            }
+            if (event1.gatherer_id != event2.gatherer_id) {
+                return event1.gatherer_id < event2.gatherer_id;
+            }
+            return event1.item_id < event2.item_id;
         }
     );
+}
+
+void FindGatherEvents(std::span<const Item> items, std::span<const Gatherer> gatherers,
+                      GatherScratch& scratch, std::vector<GatheringEvent>& gather_events) {
+    gather_events.clear();
+    const auto start = std::chrono::steady_clock::now();
+
+    const size_t items_count = items.size();
+    const size_t gatherers_count = gatherers.size();
+    auto& hits = scratch.buffers_->hits;
 
+    // per gatherer, hits come in ascending item id order, so the events match
+    // the plain double loop over TryCollectPoint one for one
+    auto add_events = [&](size_t gatherer_id) {
+        for (const auto& hit : hits) {
+            gather_events.push_back(GatheringEvent{ 
+                .item_id = hit.index,
+                .gatherer_id = gatherer_id,
+                .sq_distance = hit.sq_distance,
+                .time = hit.proj_ratio
+            });
+        }
+    };
+
+    if (items_count * gatherers_count < BROADPHASE_MIN_PAIRS) {
+        auto& block = scratch.buffers_->block;
+        block.Clear();
+        for (const auto& item : items) {
+            block.Add(item);
+        }
+        scratch.buffers_->broadphase_time = std::chrono::steady_clock::now() - start;
+        for (size_t gatherer_id = 0; gatherer_id < gatherers_count; ++gatherer_id) {
+            const auto& gatherer = gatherers[gatherer_id];
+            if (IsStanding(gatherer)) {
+                continue;
+            }
+            hits.clear();
+            block.Collect(gatherer, 0, items_count, hits);
+            add_events(gatherer_id);
+        }
+    }
+    else {
+        // broadphase: only the items inside the swept box of the gatherer are tested
+        auto& grid = scratch.buffers_->grid;
+        grid.Build(items);
+        scratch.buffers_->broadphase_time = std::chrono::steady_clock::now() - start;
+        for (size_t gatherer_id = 0; gatherer_id < gatherers_count; ++gatherer_id) {
+            const auto& gatherer = gatherers[gatherer_id];
+            if (IsStanding(gatherer)) {
+                continue;
+            }
+            const double reach = gatherer.width + grid.GetMaxItemWidth() + BROADPHASE_MARGIN;
+            grid.Collect(
+                gatherer,
+                std::min(gatherer.start_pos.x, gatherer.end_pos.x) - reach,
+                std::min(gatherer.start_pos.y, gatherer.end_pos.y) - reach,
+                std::max(gatherer.start_pos.x, gatherer.end_pos.x) + reach,
+                std::max(gatherer.start_pos.y, gatherer.end_pos.y) + reach,
+                hits
+            );
+            add_events(gatherer_id);
+        }
+    }
+
+    SortGatherEvents(gather_events);
+}
+
+std::vector<GatheringEvent> FindGatherEvents(std::span<const Item> items, std::span<const Gatherer> gatherers) {
+    GatherScratch scratch;
+    std::vector<GatheringEvent> gather_events;
+    FindGatherEvents(items, gatherers, scratch, gather_events);
     return gather_events;
 }
 
+std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider) {
+    return FindGatherEvents<ItemGathererProvider>(provider);
+}
+
 
 }  // namespace collision_detector
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include <model/dog_states.h>
+
+namespace model {
+
+void DogStates::Place(size_t slot, double pos_x, double pos_y) {
+    if (slot == Size()) {
+        x.push_back(pos_x);
+        y.push_back(pos_y);
+        prev_x.push_back(0);
+        prev_y.push_back(0);
+        speed_x.push_back(0);
+        speed_y.push_back(0);
+        join_time.push_back(time);
+        last_move_time.push_back(TimeDelta{0});
+        end_x.push_back(pos_x);
+        end_y.push_back(pos_y);
+        active_index.push_back(NOT_ACTIVE);
+        // SetSpeed never allocates: the active set can hold every slot
+        active.reserve(x.capacity());
+        return;
+    }
+    Stop(slot);
+    x[slot] = pos_x;
+    y[slot] = pos_y;
+    prev_x[slot] = 0;
+    prev_y[slot] = 0;
+    join_time[slot] = time;
+    last_move_time[slot] = TimeDelta{0};
+    end_x[slot] = pos_x;
+    end_y[slot] = pos_y;
+}
+
+void DogStates::Truncate(size_t size) {
+    for (size_t slot = size; slot < Size(); ++slot) {
+        Stop(slot);
+    }
+    auto truncate = [size](auto& values) {
+        values.resize(size);
+    };
+    truncate(x);
+    truncate(y);
+    truncate(prev_x);
+    truncate(prev_y);
+    truncate(speed_x);
+    truncate(speed_y);
+    truncate(join_time);
+    truncate(last_move_time);
+    truncate(end_x);
+    truncate(end_y);
+    truncate(active_index);
+}
+
+void DogStates::SetSpeed(size_t slot, double vel_x, double vel_y) noexcept {
+    speed_x[slot] = vel_x;
+    speed_y[slot] = vel_y;
+    const bool moving = vel_x != 0 || vel_y != 0;
+    if (moving && IsStanding(slot)) {
+        active_index[slot] = static_cast<uint32_t>(active.size());
+        active.push_back(static_cast<uint32_t>(slot));
+    }
+    else if (!moving && !IsStanding(slot)) {
+        // swap-remove from the active set
+        const auto position = active_index[slot];
+        const auto last = active.back();
+        active[position] = last;
+        active_index[last] = position;
+        active.pop_back();
+        active_index[slot] = NOT_ACTIVE;
+        last_move_time[slot] = Lifetime(slot);
+    }
+}
+
+void DogStates::Integrate(TimeDelta move_time) {
+    time += move_time;
+    const double move_time_sec = ToSeconds(move_time);
+
+    const double* __restrict pos_x = x.data();
+    const double* __restrict pos_y = y.data();
+    const double* __restrict vel_x = speed_x.data();
+    const double* __restrict vel_y = speed_y.data();
+    double* __restrict out_x = end_x.data();
+    double* __restrict out_y = end_y.data();
+
+    // mostly moving dogs: a plain loop over all slots, so the compiler emits packed SIMD code for it
+    if (2 * active.size() >= Size()) {
+        const size_t count = Size();
+        for (size_t i = 0; i < count; ++i) {
+            out_x[i] = pos_x[i] + vel_x[i] * move_time_sec;
+            out_y[i] = pos_y[i] + vel_y[i] * move_time_sec;
+        }
+        return;
+    }
+    // mostly standing dogs: only the active set is visited
+    for (auto slot : active) {
+        out_x[slot] = pos_x[slot] + vel_x[slot] * move_time_sec;
+        out_y[slot] = pos_y[slot] + vel_y[slot] * move_time_sec;
+    }
+}
+
+}  // namespace model
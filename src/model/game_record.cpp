@@ -0,0 +1,206 @@
+#include <model/game_record.h>
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace model {
+
+namespace {
+
+// fixed width values in the byte order of the host, the record is replayed on the same kind of machine
+template <typename T>
+void Write(std::ostream& output, T value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    output.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void WriteText(std::ostream& output, const std::string& text) {
+    if (text.size() > std::numeric_limits<uint16_t>::max()) {
+        throw std::invalid_argument("Recorded text is too long");
+    }
+    Write(output, static_cast<uint16_t>(text.size()));
+    output.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+template <typename T>
+bool TryRead(std::istream& input, T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    input.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return input.gcount() == static_cast<std::streamsize>(sizeof(value));
+}
+
+template <typename T>
+T Read(std::istream& input) {
+    T value;
+    if (!TryRead(input, value)) {
+        throw std::runtime_error("Game record is truncated");
+    }
+    return value;
+}
+
+std::string ReadText(std::istream& input) {
+    std::string text(Read<uint16_t>(input), '\0');
+    input.read(text.data(), static_cast<std::streamsize>(text.size()));
+    if (input.gcount() != static_cast<std::streamsize>(text.size())) {
+        throw std::runtime_error("Game record is truncated");
+    }
+    return text;
+}
+
+}  // namespace
+
+void GameRecorder::WriteHeader(const RecordHeader& header) {
+    output_.write(RecordHeader::MAGIC, sizeof(RecordHeader::MAGIC));
+    Write(output_, RecordHeader::VERSION);
+    Write(output_, header.random_seed);
+    Write(output_, static_cast<uint8_t>(header.randomize_spawn_points));
+}
+
+uint32_t GameRecorder::RecordNewSession(const Map::Id& map_id) {
+    Write(output_, RecordEventType::NEW_SESSION);
+    WriteText(output_, *map_id);
+    return sessions_++;
+}
+
+void GameRecorder::RecordJoin(uint32_t session, const Dog::Id& dog_id, const std::string& name) {
+    Write(output_, RecordEventType::JOIN);
+    Write(output_, session);
+    WriteText(output_, name);
+    // the replay numbers the dogs in the same order
+    dog_numbers_.emplace(dog_id, next_dog_++);
+}
+
+void GameRecorder::RecordMove(const Dog::Id& dog_id, DOG_MOVE move) {
+    Write(output_, RecordEventType::MOVE);
+    Write(output_, DogNumber(dog_id));
+    Write(output_, static_cast<uint8_t>(move));
+}
+
+void GameRecorder::RecordLeave(const Dog::Id& dog_id) {
+    Write(output_, RecordEventType::LEAVE);
+    Write(output_, DogNumber(dog_id));
+    dog_numbers_.erase(dog_id);
+}
+
+void GameRecorder::RecordTick(TimeDelta delta) {
+    Write(output_, RecordEventType::TICK);
+    Write(output_, static_cast<int64_t>(delta.count()));
+}
+
+uint32_t GameRecorder::DogNumber(const Dog::Id& dog_id) const {
+    auto it = dog_numbers_.find(dog_id);
+    if (it == dog_numbers_.end()) {
+        throw std::logic_error("The dog has joined before the recording");
+    }
+    return it->second;
+}
+
+RecordHeader GameRecordReader::ReadHeader() {
+    char magic[sizeof(RecordHeader::MAGIC)];
+    input_.read(magic, sizeof(magic));
+    if (input_.gcount() != sizeof(magic) || std::memcmp(magic, RecordHeader::MAGIC, sizeof(magic)) != 0) {
+        throw std::runtime_error("Not a game record");
+    }
+    if (Read<uint32_t>(input_) != RecordHeader::VERSION) {
+        throw std::runtime_error("Unsupported game record version");
+    }
+    RecordHeader header;
+    header.random_seed = Read<uint64_t>(input_);
+    header.randomize_spawn_points = Read<uint8_t>(input_) != 0;
+    return header;
+}
+
+bool GameRecordReader::Next(RecordEvent& event) {
+    if (!TryRead(input_, event.type)) {
+        return false;
+    }
+    switch (event.type) {
+        case RecordEventType::NEW_SESSION:
+            event.text = ReadText(input_);
+            break;
+        case RecordEventType::JOIN:
+            event.session = Read<uint32_t>(input_);
+            event.text = ReadText(input_);
+            break;
+        case RecordEventType::MOVE:
+        {
+            event.dog = Read<uint32_t>(input_);
+            const auto move = Read<uint8_t>(input_);
+            if (move > DOG_MOVE::STAND) {
+                throw std::runtime_error("Unknown move in game record");
+            }
+            event.move = static_cast<DOG_MOVE>(move);
+            break;
+        }
+        case RecordEventType::LEAVE:
+            event.dog = Read<uint32_t>(input_);
+            break;
+        case RecordEventType::TICK:
+            event.delta = TimeDelta{Read<int64_t>(input_)};
+            break;
+        default:
+            throw std::runtime_error("Unknown game record event");
+    }
+    return true;
+}
+
+GameReplay::GameReplay(Game& game, const RecordHeader& header)
+    : game_{game} {
+    game_.SetRandomSeed(header.random_seed);
+    game_.SetRandomizeSpawnPoints(header.randomize_spawn_points);
+}
+
+void GameReplay::Apply(const RecordEvent& event) {
+    switch (event.type) {
+        case RecordEventType::NEW_SESSION:
+        {
+            const Map::Id map_id{event.text};
+            if (game_.FindMap(map_id) == nullptr) {
+                throw std::runtime_error("Game record refers to unknown map " + event.text);
+            }
+            sessions_.push_back(game_.AddGameSession(map_id));
+            break;
+        }
+        case RecordEventType::JOIN:
+        {
+            auto session = FindSession(event.session);
+            dogs_.push_back(DogRef{session, session->AddDog(event.text)->GetId()});
+            break;
+        }
+        case RecordEventType::MOVE:
+        {
+            const auto& dog = FindDog(event.dog);
+            dog.session->MoveDog(dog.dog_id, event.move);
+            break;
+        }
+        case RecordEventType::LEAVE:
+        {
+            const auto& dog = FindDog(event.dog);
+            dog.session->DeleteDog(dog.dog_id);
+            break;
+        }
+        case RecordEventType::TICK:
+            game_.Tick(event.delta);
+            ++ticks_;
+            game_time_ += event.delta;
+            break;
+    }
+}
+
+GameSession* GameReplay::FindSession(uint32_t session) const {
+    if (session >= sessions_.size()) {
+        throw std::runtime_error("Game record refers to unknown session");
+    }
+    return sessions_[session];
+}
+
+const GameReplay::DogRef& GameReplay::FindDog(uint32_t dog) const {
+    if (dog >= dogs_.size()) {
+        throw std::runtime_error("Game record refers to unknown dog");
+    }
+    return dogs_[dog];
+}
+
+}  // namespace model
@@ -1,7 +1,9 @@
 #include <model/model.h>
+#include <algorithm>
 #include <random>
 #include <stdexcept>
 #include <collision_detector.h>
+#include <game_record.h>
 
 namespace model {
 using namespace std::literals;
@@ -9,6 +11,8 @@ using namespace std::literals;
 static constexpr double LOOT_WIDTH = 0.0;
 static constexpr double DOG_WIDTH = 0.6/2;
 static constexpr double OFFICE_WIDTH = 0.5/2;
+// extra reach of a gatherer when it is assigned to the regions, covers rounding errors
+static constexpr double REGION_MARGIN = 1e-6;
 
 void Map::AddOffice(const Office &office) {
     if (warehouse_id_to_index_.contains(office.GetId())) {
@@ -32,6 +36,8 @@ void Game::AddMap(const Map& map) {
     } else {
         try {
             maps_.emplace_back(std::move(map));
+            maps_.back().BuildRoadIndex();
+            maps_.back().BuildRoadSampler();
         } catch (...) {
             map_id_to_index_.erase(it);
             throw;
@@ -47,102 +53,332 @@ const Map* Game::FindMap(const Map::Id& id) const noexcept {
 }
 
 GameSession* Game::FindGameSession(const Map::Id& id) noexcept {
-    if (auto it = map_id_to_game_sessions_index_.find(id);
-        it != map_id_to_game_sessions_index_.end()) {
-        return &game_sessions_.at(it->second);
+    auto it = map_id_to_game_sessions_.find(id);
+    if (it == map_id_to_game_sessions_.end()) {
+        return nullptr;
+    }
+    auto max_players = FindMap(id)->GetSessionMaxPlayers();
+    GameSession* least_loaded = nullptr;
+    for (auto session : it->second) {
+        auto players = session->GetDogs().Size();
+        if (max_players != 0 && players >= max_players) {
+            continue;
+        }
+        if (least_loaded == nullptr || players < least_loaded->GetDogs().Size()) {
+            least_loaded = session;
+        }
+    }
+    return least_loaded;
+}
+
+GameSession* Game::FindDogSession(const Map::Id& id, const Dog::Id& dog_id) noexcept {
+    if (auto it = map_id_to_game_sessions_.find(id);
+        it != map_id_to_game_sessions_.end()) {
+        for (auto session : it->second) {
+            if (session->FindDog(dog_id) != nullptr) {
+                return session;
+            }
+        }
     }
     return nullptr;
 }
 
+uint64_t Game::MakeSessionSeed() {
+    if (random_seed_) {
+        return *random_seed_ + sessions_seeded_++;
+    }
+    std::random_device random_device;
+    return (static_cast<uint64_t>(random_device()) << 32) | random_device();
+}
+
 GameSession* Game::AddGameSession(const Map::Id& id) {
-    GameSession gs { 
+    auto gs = std::make_unique<GameSession>(
         FindMap(id), 
         IsRandomizeSpawnPoints(),
-        loot_generator_config_
-    };
+        loot_generator_config_,
+        MakeSessionSeed()
+    );
 
-    auto index = game_sessions_.size();
+    gs->SetId(sessions_opened_++);
     game_sessions_.emplace_back(std::move(gs));
     try {
-        map_id_to_game_sessions_index_.emplace(id, index);
+        map_id_to_game_sessions_[id].push_back(game_sessions_.back().get());
     }
     catch (...) {
         game_sessions_.pop_back();
         throw;
     }
-    return &game_sessions_.back();
+    if (recorder_) {
+        game_sessions_.back()->SetRecorder(recorder_, recorder_->RecordNewSession(id));
+    }
+    return game_sessions_.back().get();
 }
 
-void Game::Tick(uint64_t time_delta) {
-    for (auto& game_session : game_sessions_) {
-        game_session.Tick(time_delta);
+void Game::SetRecorder(GameRecorder* recorder) {
+    if (!game_sessions_.empty()) {
+        throw std::logic_error("Recording must start before the first game session");
     }
-
-    if (!tick_signal_.empty()) {
-        tick_signal_(std::chrono::milliseconds(time_delta));
+    if (!random_seed_) {
+        throw std::logic_error("Recording needs a random seed");
     }
+    recorder_ = recorder;
+    recorder_->WriteHeader(RecordHeader{
+        .random_seed = *random_seed_ + sessions_seeded_,
+        .randomize_spawn_points = randomize_spawn_points_
+    });
 }
 
-void GameSession::Tick(uint64_t time_delta) {
-    // move dogs
-    for (auto& dog : dogs_) {
-
-        dog.IncLifetime(std::chrono::milliseconds(time_delta));
+void Game::Tick(TimeDelta time_delta) {
+    // dormant sessions only advance their clocks, the rest are ticked
+    awake_sessions_.clear();
+    for (size_t index = 0; index < game_sessions_.size(); ++index) {
+        auto& game_session = game_sessions_[index];
+        // queued moves are applied in this thread before any session ticks, so they are recorded in order
+        game_session->ApplyQueuedMoves();
+        if (game_session->IsDormant()) {
+            game_session->Idle(time_delta);
+        }
+        else if (tick_executor_ && game_session->GetDogs().Size() >= partition_min_dogs_) {
+            // a large session alone uses all the threads
+            game_session->Tick(time_delta, tick_executor_.get());
+            CheckSlowTick(*game_session);
+        }
+        else {
+            awake_sessions_.push_back(index);
+        }
+    }
+    if (recorder_) {
+        recorder_->RecordTick(time_delta);
+    }
 
-        if (dog.IsStanding()) {
-            continue;
+    if (tick_executor_ && awake_sessions_.size() > 1) {
+        // sessions don't share mutable state, all of them are ticked before the listeners run
+        tick_costs_.resize(game_sessions_.size());
+        awake_costs_.clear();
+        for (auto index : awake_sessions_) {
+            awake_costs_.push_back(tick_costs_[index]);
+        }
+        tick_executor_->Run(awake_costs_, [this, time_delta](size_t awake_index) {
+            game_sessions_[awake_sessions_[awake_index]]->Tick(time_delta);
+        });
+        for (size_t awake_index = 0; awake_index < awake_sessions_.size(); ++awake_index) {
+            tick_costs_[awake_sessions_[awake_index]] = awake_costs_[awake_index];
+        }
+    }
+    else {
+        for (auto index : awake_sessions_) {
+            game_sessions_[index]->Tick(time_delta);
         }
+    }
+    for (auto index : awake_sessions_) {
+        CheckSlowTick(*game_sessions_[index]);
+    }
 
-        auto start_pos = dog.GetCoordinate();
-        auto end_pos = dog.GetEndCoordinate(time_delta);
-        auto move_pos = MoveDog(start_pos, end_pos);
-        dog.SetCoordinate(move_pos);
+    ReclaimGameSessions();
+}
 
-        // if the dog is on the border, it is necessery to stop him
-        if (move_pos != end_pos) { 
-            dog.StopMove();
-        }
+void Game::CheckSlowTick(GameSession& game_session) {
+    if (!slow_tick_handler_) {
+        return;
+    }
+    const auto& times = game_session.GetLastTickTimes();
+    if (times.Total() <= slow_tick_threshold_) {
+        return;
+    }
+    slow_tick_handler_(SlowSessionTick{
+        .session_id = game_session.GetId(),
+        .map_id = game_session.MapId(),
+        .dogs = game_session.GetDogs().Size(),
+        .loots = game_session.GetLoots().Size(),
+        .times = times
+    });
+}
+
+TickProfile Game::TakeTickProfile() {
+    auto profile = std::exchange(reclaimed_profile_, TickProfile{});
+    for (auto& game_session : game_sessions_) {
+        profile.Merge(game_session->TakeTickProfile());
     }
+    return profile;
+}
+
+void GameSession::Tick(TimeDelta time_delta, TickExecutor* executor) {
+    PhaseTimer timer{last_tick_times_};
+    ++version_;
+    // move dogs: integrate the active set at once, then keep the dogs on the roads
+    dog_states_.Integrate(time_delta);
+    MoveActiveDogs(executor);
+    timer.Lap(TickPhase::MOVEMENT);
 
     // generate loots
     auto cnt_loot = loot_generator_.Generate(
-                                                std::chrono::milliseconds(time_delta), 
-                                                loots_.size(), 
-                                                dogs_.size()
+                                                time_delta, 
+                                                loot_pool_.Size(), 
+                                                dogs_.Size()
     );
 
-    std::random_device random_device_;
-    std::uniform_int_distribution<int> dist{0, const_cast<Map*>(map_)->GetLootTypesCount() - 1};
+    const auto loot_types_count = static_cast<size_t>(const_cast<Map*>(map_)->GetLootTypesCount());
 
     for (auto i = 0; i < cnt_loot; i++) {
-        loots_.push_back(
+        loot_pool_.Spawn(
             Loot { 
                 .id = GetNextLootId(),
-                .type = dist(random_device_), 
+                .type = static_cast<int>(random_engine_.NextIndex(loot_types_count)), 
                 .coordinate = GetRandomRoadCoordinate() 
             }
         );
     }
+    timer.Lap(TickPhase::LOOT_GENERATION);
 
     // check pick-ups & returns loots
-    PickUpAndReturnLoots();
+    PickUpAndReturnLoots(timer, executor);
+
+    // drop the slots freed by deleted dogs at the end of the storage
+    if (dogs_.FreeCount() != 0) {
+        CompactDogs();
+    }
+    TrackEmptyTime(time_delta);
+    tick_profile_.Add(last_tick_times_);
 }
 
-void GameSession::DeleteDog(const Dog::Id& dog_id) {
-    if (dogs_id_to_index_.contains(dog_id)) {
-        auto idx = dogs_id_to_index_.at(dog_id);
-        dogs_.erase(dogs_.begin() + idx);
-        dogs_id_to_index_.erase(dog_id);
+void GameSession::ApplyQueuedMoves() {
+    if (move_queue_->Empty()) {
+        return;
+    }
+    // the newest move of every dog wins: the drained moves come newest first,
+    // the stable sort keeps that order among the moves of one dog
+    move_queue_->Drain(queued_moves_);
+    std::stable_sort(queued_moves_.begin(), queued_moves_.end(), [](const DogAction& l, const DogAction& r) {
+        return *l.dog_id < *r.dog_id;
+    });
+    for (size_t i = 0; i < queued_moves_.size(); ++i) {
+        if (i == 0 || queued_moves_[i].dog_id != queued_moves_[i - 1].dog_id) {
+            MoveDog(queued_moves_[i].dog_id, queued_moves_[i].move);
+        }
+    }
+}
+
+void GameSession::MoveActiveDogs(TickExecutor* executor) {
+    moved_slots_.assign(dog_states_.active.begin(), dog_states_.active.end());
+    // dogs move independently, the stops change the active set, so they are applied afterwards
+    auto move_dogs = [this](size_t first, size_t last, std::vector<uint32_t>& stopped_slots) {
+        stopped_slots.clear();
+        for (size_t i = first; i < last; ++i) {
+            const auto slot = moved_slots_[i];
+            auto start_pos = DogCoordinate{ dog_states_.x[slot], dog_states_.y[slot] };
+            auto end_pos = DogCoordinate{ dog_states_.end_x[slot], dog_states_.end_y[slot] };
+            auto move_pos = MoveDog(start_pos, end_pos);
+            dog_states_.MoveTo(slot, move_pos.x, move_pos.y);
+
+            // if the dog is on the border, it is necessery to stop him
+            if (move_pos != end_pos) {
+                stopped_slots.push_back(slot);
+            }
+        }
+    };
+
+    const size_t count = moved_slots_.size();
+    const size_t chunks = executor != nullptr ? RegionsCount(*executor) : 1;
+    stopped_slots_.resize(std::max(stopped_slots_.size(), chunks));
+    if (chunks == 1) {
+        move_dogs(0, count, stopped_slots_.front());
     }
+    else {
+        move_costs_.resize(chunks);
+        executor->Run(move_costs_, [&](size_t chunk) {
+            move_dogs(count * chunk / chunks, count * (chunk + 1) / chunks, stopped_slots_[chunk]);
+        });
+    }
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        for (auto slot : stopped_slots_[chunk]) {
+            dog_states_.Stop(slot);
+        }
+    }
+}
+
+size_t GameSession::RegionsCount(const TickExecutor& executor) noexcept {
+    // a few tasks per thread let the executor even out the uneven ones
+    return 2 * static_cast<size_t>(executor.GetThreadsCount());
+}
+
+void GameSession::Idle(TimeDelta time_delta) {
+    // lifetimes and stay times follow the clock, standing dogs are not touched
+    dog_states_.time += time_delta;
+    loot_generator_.Skip(time_delta);
+    if (dogs_.FreeCount() != 0) {
+        CompactDogs();
+    }
+    TrackEmptyTime(time_delta);
+}
+
+void GameSession::TrackEmptyTime(TimeDelta time_delta) noexcept {
+    empty_time_ = dogs_.Empty() ? empty_time_ + time_delta : TimeDelta{0};
+}
+
+void Game::ReclaimGameSessions() {
+    if (session_empty_time_ == 0ms) {
+        return;
+    }
+    for (size_t index = 0; index < game_sessions_.size();) {
+        auto& game_session = game_sessions_[index];
+        if (!game_session->GetDogs().Empty() || game_session->GetEmptyTime() < session_empty_time_) {
+            ++index;
+            continue;
+        }
+        // an empty session has no players, nothing refers to it but the map's session list
+        auto& map_sessions = map_id_to_game_sessions_[game_session->MapId()];
+        std::erase(map_sessions, game_session.get());
+        if (map_sessions.empty()) {
+            map_id_to_game_sessions_.erase(game_session->MapId());
+        }
+        reclaimed_profile_.Merge(game_session->TakeTickProfile());
+        // the order of the sessions doesn't matter: swap with the last one
+        const auto last = game_sessions_.size() - 1;
+        if (index != last) {
+            std::swap(game_session, game_sessions_[last]);
+            if (tick_costs_.size() == game_sessions_.size()) {
+                std::swap(tick_costs_[index], tick_costs_[last]);
+            }
+        }
+        game_sessions_.pop_back();
+        tick_costs_.resize(std::min(tick_costs_.size(), game_sessions_.size()));
+    }
+}
+
+void GameSession::DeleteDog(const Dog::Id& dog_id) {
+    auto it = dogs_by_id_.find(dog_id);
+    if (it == dogs_by_id_.end()) {
+        return;
+    }
+    auto handle = it->second;
+    auto dog = dogs_.Get(handle);
+    // loots of the bag leave the game with the dog
+    for (auto loot : dog->GetBag()) {
+        loot_pool_.Release(loot);
+    }
+    if (recorder_) {
+        recorder_->RecordLeave(dog_id);
+    }
+    dogs_by_name_.erase(dog->GetName());
+    dogs_by_id_.erase(it);
+    ++version_;
+    // a free slot must be skipped by Tick
+    dog_states_.Stop(handle.index);
+    dogs_.Erase(handle);
 }
 
-void Game::SetGameSessions(const GameSessions& game_sessions) {
-    for (auto& game_session : const_cast<GameSessions&>(game_sessions)) {
-        auto id = game_session.MapId();
-        auto index = game_sessions_.size();
-        game_sessions_.emplace_back(game_session);
+void GameSession::CompactDogs() {
+    dogs_.Compact();
+    dog_states_.Truncate(dogs_.Capacity());
+}
+
+void Game::SetGameSessions(GameSessions&& game_sessions) {
+    for (auto& game_session : game_sessions) {
+        auto id = game_session->MapId();
+        game_session->SetId(sessions_opened_++);
+        game_sessions_.emplace_back(std::move(game_session));
         try {
-            map_id_to_game_sessions_index_.emplace(id, index);
+            map_id_to_game_sessions_[id].push_back(game_sessions_.back().get());
         }
         catch (...) {
             game_sessions_.pop_back();
@@ -151,16 +387,17 @@ void Game::SetGameSessions(const GameSessions& game_sessions) {
     }
 }
 
-void GameSession::PickUpAndReturnLoots()
+void GameSession::PickUpAndReturnLoots(PhaseTimer& timer, TickExecutor* executor)
 {
-    collision_detector::ItemGatherer item_gatherer;
-    std::map<size_t, model::Dog*> map_dogs;
-    std::map<size_t, decltype(loots_.begin())> map_loots;
-    auto dog_idx = 0;
-    auto loot_idx = 0;
-    for (auto& dog : dogs_) {
-        map_dogs[dog_idx++] = &dog;
-        item_gatherer.Add(
+    // scratch buffers keep their capacity between ticks, so the pass doesn't allocate in steady state
+    item_gatherer_.Clear();
+    gatherer_dogs_.clear();
+    // a standing dog sweeps nothing; slot order keeps the events independent of the active set order
+    std::sort(moved_slots_.begin(), moved_slots_.end());
+    for (auto slot : moved_slots_) {
+        auto& dog = *dogs_.At(slot);
+        gatherer_dogs_.push_back(&dog);
+        item_gatherer_.Add(
             collision_detector::Gatherer { 
                 .start_pos = geom::Point2D {
                     dog.GetStartPos().x,
@@ -174,13 +411,15 @@ void GameSession::PickUpAndReturnLoots()
             }
         );
     }
-    for (auto loot = loots_.begin(); loot != loots_.end(); ++loot) {
-        map_loots[loot_idx++] = loot;
-        item_gatherer.Add(
+    // pick-ups reorder the loots on the map, so the items refer to a snapshot of the handles
+    gathered_loots_.assign(loot_pool_.OnMap().begin(), loot_pool_.OnMap().end());
+    for (auto handle : gathered_loots_) {
+        const auto& loot = loot_pool_.Get(handle);
+        item_gatherer_.Add(
             collision_detector::Item { 
                 .position = geom::Point2D {
-                    loot->coordinate.x,
-                    loot->coordinate.y
+                    loot.coordinate.x,
+                    loot.coordinate.y
                 },
                 .width = LOOT_WIDTH
             }
@@ -188,7 +427,7 @@ void GameSession::PickUpAndReturnLoots()
     }
     for (const auto& office : map_->GetOffices()) {
         auto office_pos = office.GetPosition();
-        item_gatherer.Add(
+        item_gatherer_.Add(
             collision_detector::Item { 
                 .position = geom::Point2D { 
                     office_pos.x, 
@@ -198,87 +437,183 @@ void GameSession::PickUpAndReturnLoots()
             }
         );
     }
-    auto gathering_events = collision_detector::FindGatherEvents(item_gatherer);
-    auto sz_loots = loots_.size();
-    for (const auto& gathering_event : gathering_events) {
+    timer.Lap(TickPhase::BROADPHASE);
+    if (executor != nullptr) {
+        FindGatherEventsInRegions(timer, *executor);
+    }
+    else {
+        collision_detector::FindGatherEvents(
+            item_gatherer_.GetItems(), 
+            item_gatherer_.GetGatherers(), 
+            gather_scratch_, 
+            gather_events_
+        );
+        timer.Lap(TickPhase::NARROWPHASE);
+        timer.Reassign(TickPhase::NARROWPHASE, TickPhase::BROADPHASE, gather_scratch_.GetBroadphaseTime());
+    }
+    // events are applied in one thread, so the bag capacity checks and the races
+    // for one loot are resolved in the same order as without regions
+    auto sz_loots = gathered_loots_.size();
+    for (const auto& gathering_event : gather_events_) {
         // it's office
         if (gathering_event.item_id >= sz_loots) {
             // return all loots to base
-            map_dogs[gathering_event.gatherer_id]->ReturnLoots(const_cast<Map*>(map_)->GetLootScores());
+            gatherer_dogs_[gathering_event.gatherer_id]->ReturnLoots(const_cast<Map*>(map_)->GetLootScores());
             continue;
         }
         // it's loot
-        if (map_loots.contains(gathering_event.item_id)) {
+        auto loot = gathered_loots_[gathering_event.item_id];
+        if (loot_pool_.IsOnMap(loot)) {
             // bag is full don't pick-up loot
-            if (map_dogs[gathering_event.gatherer_id]->GetLoots().size() >= map_->GetBagCapacity()) {
+            if (gatherer_dogs_[gathering_event.gatherer_id]->GetBag().size() >= map_->GetBagCapacity()) {
                 continue;
             }
             // pick-up loot
-            map_dogs[gathering_event.gatherer_id]->PickUpLoot(
-                loots_, 
-                map_loots[gathering_event.item_id]
-            );
-            map_loots.erase(gathering_event.item_id);
+            gatherer_dogs_[gathering_event.gatherer_id]->PickUpLoot(loot);
+        }
+    }
+    timer.Lap(TickPhase::EVENTS);
+}
+
+void GameSession::FindGatherEventsInRegions(PhaseTimer& timer, TickExecutor& executor) {
+    const auto& items = item_gatherer_.GetItems();
+    const auto& gatherers = item_gatherer_.GetGatherers();
+    const size_t regions_count = RegionsCount(executor);
+    if (regions_.size() < regions_count) {
+        regions_.resize(regions_count);
+    }
+
+    gather_events_.clear();
+    if (items.empty()) {
+        timer.Lap(TickPhase::BROADPHASE);
+        return;
+    }
+
+    // stripe borders along x at the quantiles of the items, so the regions hold about as many items
+    double max_item_width = 0;
+    region_xs_.clear();
+    for (const auto& item : items) {
+        region_xs_.push_back(item.position.x);
+        max_item_width = std::max(max_item_width, item.width);
+    }
+    region_borders_.clear();
+    auto first = region_xs_.begin();
+    for (size_t region = 1; region < regions_count; ++region) {
+        auto nth = region_xs_.begin() + static_cast<std::ptrdiff_t>(region_xs_.size() * region / regions_count);
+        std::nth_element(first, nth, region_xs_.end());
+        region_borders_.push_back(*nth);
+        first = nth;
+    }
+    auto region_of = [this](double x) {
+        return static_cast<size_t>(std::upper_bound(region_borders_.begin(), region_borders_.end(), x) - region_borders_.begin());
+    };
+
+    for (size_t region = 0; region < regions_count; ++region) {
+        regions_[region].item_gatherer.Clear();
+        regions_[region].item_ids.clear();
+        regions_[region].gatherer_ids.clear();
+    }
+    // every item belongs to one region, so every item-gatherer pair is tested once
+    for (size_t item_id = 0; item_id < items.size(); ++item_id) {
+        auto& region = regions_[region_of(items[item_id].position.x)];
+        region.item_gatherer.Add(collision_detector::Item{items[item_id]});
+        region.item_ids.push_back(item_id);
+    }
+    // a gatherer joins every region its swept box reaches, borders are crossed here
+    for (size_t gatherer_id = 0; gatherer_id < gatherers.size(); ++gatherer_id) {
+        const auto& gatherer = gatherers[gatherer_id];
+        const double reach = gatherer.width + max_item_width + REGION_MARGIN;
+        const auto first = region_of(std::min(gatherer.start_pos.x, gatherer.end_pos.x) - reach);
+        const auto last = region_of(std::max(gatherer.start_pos.x, gatherer.end_pos.x) + reach);
+        for (auto region = first; region <= last; ++region) {
+            regions_[region].item_gatherer.Add(collision_detector::Gatherer{gatherer});
+            regions_[region].gatherer_ids.push_back(gatherer_id);
         }
     }
+
+    // the grids of the regions are built on the threads and count as the narrowphase
+    timer.Lap(TickPhase::BROADPHASE);
+    region_costs_.resize(regions_count);
+    executor.Run(region_costs_, [this](size_t index) {
+        auto& region = regions_[index];
+        collision_detector::FindGatherEvents(
+            region.item_gatherer.GetItems(),
+            region.item_gatherer.GetGatherers(),
+            region.scratch,
+            region.events
+        );
+        for (auto& event : region.events) {
+            event.item_id = region.item_ids[event.item_id];
+            event.gatherer_id = region.gatherer_ids[event.gatherer_id];
+        }
+    });
+
+    // deterministic merge: the total order of SortGatherEvents doesn't depend on the regions
+    for (size_t region = 0; region < regions_count; ++region) {
+        gather_events_.insert(gather_events_.end(), regions_[region].events.begin(), regions_[region].events.end());
+    }
+    collision_detector::SortGatherEvents(gather_events_);
+    timer.Lap(TickPhase::NARROWPHASE);
 }
 
-void GameSession::PushLootsToMap(std::chrono::milliseconds time_delta_ms)
+void GameSession::PushLootsToMap(TimeDelta time_delta)
 {
     auto cnt_loot = loot_generator_.Generate(
-        time_delta_ms,
-        static_cast<int>(loots_.size()), 
-        static_cast<int>(dogs_.size())
+        time_delta,
+        static_cast<int>(loot_pool_.Size()), 
+        static_cast<int>(dogs_.Size())
     );
 
-    std::random_device random_device_;
-    std::uniform_int_distribution<int> dist{0, const_cast<Map*>(map_)->GetLootTypesCount() - 1};
+    const auto loot_types_count = static_cast<size_t>(const_cast<Map*>(map_)->GetLootTypesCount());
 
     for (auto i = 0; i < cnt_loot; i++) {
-        loots_.push_back(
-            std::move(
-                Loot {
-                    .id = GetNextLootId(),
-                    .type = dist(random_device_),
-                    .coordinate = GetRandomRoadCoordinate() 
-                }
-            )
+        loot_pool_.Spawn(
+            Loot {
+                .id = GetNextLootId(),
+                .type = static_cast<int>(random_engine_.NextIndex(loot_types_count)),
+                .coordinate = GetRandomRoadCoordinate() 
+            }
         );
     }
 }
 
-bool Dog::IsStanding() {
-    return dog_speed_ == DogSpeed{0,0};
-}
-
-DogCoordinate Dog::GetEndCoordinate(uint64_t move_time) {
+DogCoordinate Dog::GetEndCoordinate(TimeDelta move_time) const {
     if (IsStanding()) {
-        return dog_coordinate_;
+        return GetCoordinate();
     }
 
-    double move_time_sec = static_cast<double>(move_time) / 1000.0;
+    double move_time_sec = ToSeconds(move_time);
+    auto speed = GetSpeed();
+    auto coordinate = GetCoordinate();
     return DogCoordinate {
-        dog_coordinate_.x + dog_speed_.x * move_time_sec,
-        dog_coordinate_.y + dog_speed_.y * move_time_sec
+        coordinate.x + speed.x * move_time_sec,
+        coordinate.y + speed.y * move_time_sec
     };
 }
 
-Dog& Dog::operator=(const Dog& other) {
-    if (this == &other) {
-        return *this;
+template <typename... Args>
+Dog* GameSession::PlaceDog(const DogCoordinate& coordinate, const Args&... dog_args) {
+    const size_t slot = dogs_.NextIndex();
+    dog_states_.Place(slot, coordinate.x, coordinate.y);
+    auto handle = dogs_.Emplace(dog_args..., dog_states_, slot, loot_pool_);
+    auto dog = dogs_.Get(handle);
+    try {
+        dog->ReserveBag(map_->GetBagCapacity());
+        dogs_by_id_.emplace(dog->GetId(), handle);
+        try {
+            dogs_by_name_.emplace(dog->GetName(), handle);
+        }
+        catch (...) {
+            dogs_by_id_.erase(dog->GetId());
+            throw;
+        }
     }
-
-    id_ = other.id_;
-    dog_name_ = other.dog_name_;
-    dog_coordinate_  = other.dog_coordinate_;
-    prev_dog_coordinate_ = other.prev_dog_coordinate_;
-    dog_speed_  = other.dog_speed_;
-    dog_direction_ = other.dog_direction_;
-    loots_ = other.loots_;
-    score_  = other.score_;
-    last_move_time_ = other.last_move_time_;
-    lifetime_ = other.lifetime_;
-    return *this;
+    catch (...) {
+        dogs_.Erase(handle);
+        throw;
+    }
+    ++version_;
+    return dog;
 }
 
 Dog* GameSession::AddDog(const std::string& dog_name)
@@ -286,220 +621,113 @@ Dog* GameSession::AddDog(const std::string& dog_name)
     if (FindDog(dog_name) != nullptr) {
         throw std::invalid_argument("Dog with name <" + dog_name + "> already exists!");
     }
-    auto dog = randomize_spawn_points_ ? Dog(dog_name, GetRandomRoadCoordinate()) : Dog(dog_name, DogCoordinate{.x = 0.0, .y = 0.0});
-    auto index = dogs_.size();
-    auto o = dogs_.emplace_back(std::move(dog));
-    try {
-        dogs_id_to_index_.emplace(o.GetId(), index);
-    }
-    catch (...) {
-        // Удаляем офис из вектора, если не удалось вставить в unordered_map
-        dogs_.pop_back();
-        throw;
-    }
+    auto coordinate = randomize_spawn_points_ ? GetRandomRoadCoordinate() : DogCoordinate{.x = 0.0, .y = 0.0};
+    auto dog = PlaceDog(coordinate, dog_name);
 
-    std::random_device random_device_;
-    std::uniform_int_distribution<int> dist{0, const_cast<Map*>(map_)->GetLootTypesCount() - 1};
+    const auto loot_types_count = static_cast<size_t>(const_cast<Map*>(map_)->GetLootTypesCount());
 
-    loots_.push_back(
+    loot_pool_.Spawn(
         Loot {
             .id = GetNextLootId(), 
-            .type = dist(random_device_),
+            .type = static_cast<int>(random_engine_.NextIndex(loot_types_count)),
             .coordinate = GetRandomRoadCoordinate() 
         }
     );
-    return &dogs_.back();
-    //return nullptr;
+    if (recorder_) {
+        recorder_->RecordJoin(record_serial_, dog->GetId(), dog_name);
+    }
+    return dog;
+}
+
+Dog* GameSession::RestoreDog(const Dog::Id& dog_id, const std::string& dog_name, const DogCoordinate& coordinate) {
+    return PlaceDog(coordinate, dog_name, dog_id);
 }
 
 Dog* GameSession::FindDog(const std::string& dog_name)
 {
-    for (auto& dog : dogs_) {
-        if (dog.GetName() == dog_name) {
-            return &dog;
-        }
+    if (auto it = dogs_by_name_.find(dog_name); it != dogs_by_name_.end()) {
+        return dogs_.Get(it->second);
     }
     return nullptr;
 }
 
 DogCoordinate GameSession::GetRandomRoadCoordinate()
 {
-    std::random_device random_device_;
-    auto random_coordinate = [&](auto x, auto y) {
-        if (y < x) {
-            std::swap(x, y);
-        }
-        std::uniform_real_distribution<double> dist(x, y);
-        return dist(random_device_); 
-    };
-
-    auto roads = map_->GetRoads();
-
-    if (roads.size() == 0) {
+    const auto& sampler = map_->GetRoadSampler();
+    if (sampler.IsEmpty()) {
         return DogCoordinate();
     }
-
-    // choose random road
-    std::uniform_int_distribution<size_t> dist{0, roads.size()-1};
-    auto road = roads[dist(random_device_)];
-
-    DogCoordinate coordinate;
-
-    if (road.IsHorizontal()) {
-        auto start_point = road.GetStart();
-        auto end_point = road.GetEnd();
-        coordinate.x = random_coordinate(start_point.x, end_point.x);
-        coordinate.y = end_point.y;
-    }
-    else {
-        auto start_point = road.GetStart();
-        auto end_point = road.GetEnd();
-        coordinate.y = random_coordinate(start_point.y, end_point.y);
-        coordinate.x = end_point.x;
-    }
-    return coordinate;
+    auto point = sampler.Sample(random_engine_);
+    return DogCoordinate{.x = point.x, .y = point.y};
 }
 
 void GameSession::MoveDog(const Dog::Id& dog_id, const DOG_MOVE& dog_move) {
-    auto& dog = dogs_[dogs_id_to_index_[dog_id]];
-    dog.Direction(dog_move, map_->GetDogSpeed());
-}
-
-bool GameSession::IsCoordinateOnRoad(const RoadMapIter& roads, const DogCoordinate& coordinate) {
-    for (auto it = roads.first; it != roads.second; ++it) {
-        auto road = it->second;
-        
-        // road border coordinates
-        auto road_start = road->GetStart();
-        auto road_end = road->GetEnd();
-        auto x0 = std::min(road_start.x, road_end.x) - 0.4;
-        auto x1 = std::max(road_start.x, road_end.x) + 0.4;
-        auto y0 = std::min(road_start.y, road_end.y) - 0.4;
-        auto y1 = std::max(road_start.y, road_end.y) + 0.4;
-
-        if (
-            coordinate.x >= x0 && 
-            coordinate.x <= x1 && 
-            coordinate.y >= y0 && 
-            coordinate.y <= y1
-        ) {
-            return true;
+    if (auto dog = FindDog(dog_id)) {
+        if (recorder_) {
+            recorder_->RecordMove(dog_id, dog_move);
         }
+        dog->Direction(dog_move, map_->GetDogSpeed());
+        ++version_;
     }
-    return false;
 }
 
 DogCoordinate GameSession::MoveDog(const DogCoordinate& start_coordinate, const DogCoordinate& end_coordinate) {
-    auto road_point_round = [](auto pos) {
-        return Point { 
-            .x = static_cast<Coord>(std::round(pos.x)),
-            .y = static_cast<Coord>(std::round(pos.y))
-        };
-    };
-
     // start_coordinate and end_coordinate are same
     if (start_coordinate == end_coordinate) {
         return start_coordinate;
     }
 
-    // round start_coordinate for road Point format
-    auto start_pos_round = road_point_round(start_coordinate);
-
-    // select roads which contain start_pos_round
-    auto selected_start_pos_roads = road_map_.equal_range(start_pos_round);
-
-    // check that end_coordinate in on one of selected_start_pos_roads (on road)
-    if (IsCoordinateOnRoad(selected_start_pos_roads, end_coordinate)) {
-        return end_coordinate;
-    }
-
-    // dog is on road border
-    // find border coordinate
-    return FindBorderCoordinate(selected_start_pos_roads, end_coordinate);
-}
-
-DogCoordinate GameSession::FindBorderCoordinate(const RoadMapIter& roads, const DogCoordinate& end_coordinate) {
-    double minimum_distance = std::numeric_limits<double>::max();
-    double distance;
-    DogCoordinate border_coordinate;
-    for (auto it = roads.first; it != roads.second; ++it) {
-        // get road
-        auto road = it->second;
-        
-        // calculate road border coordinates
-        auto road_start = road->GetStart();
-        auto road_end = road->GetEnd();
-        auto x0 = std::min(road_start.x, road_end.x) - 0.4;
-        auto x1 = std::max(road_start.x, road_end.x) + 0.4;
-        auto y0 = std::min(road_start.y, road_end.y) - 0.4;
-        auto y1 = std::max(road_start.y, road_end.y) + 0.4;
-
-        // find border_coordinate with minimum distance to end_coordinate from roads which contain start coordinate
-        if (end_coordinate.x >= x0 && end_coordinate.x <= x1) {
-            if (end_coordinate.y <= y0) {
-                if ((distance = std::abs(y0 - end_coordinate.y)) < minimum_distance) {
-                    minimum_distance = distance;
-                    border_coordinate.y = y0;
-                    border_coordinate.x = end_coordinate.x;
-                    continue;
-                }
-            }
-            if (end_coordinate.y >= y1) {
-                if ((distance = std::abs(y1 - end_coordinate.y)) < minimum_distance) {
-                    minimum_distance = distance;
-                    border_coordinate.y = y1;
-                    border_coordinate.x = end_coordinate.x;
-                    continue;
-                }
-            }
+    // dogs move along one axis, walk along it from one road end to the next one:
+    // roads of the current cell give the reach, if it crosses the cell border,
+    // the walk continues from the cell at the reach, otherwise the dog stops at the reach
+    const bool along_x = end_coordinate.x != start_coordinate.x;
+    const bool forward = along_x ? end_coordinate.x > start_coordinate.x : end_coordinate.y > start_coordinate.y;
+    const double target = along_x ? end_coordinate.x : end_coordinate.y;
+    auto position = start_coordinate;
+    double& pos = along_x ? position.x : position.y;
+
+    while (true) {
+        auto reach = FindRoadReach(position, along_x, forward);
+        if (forward ? target <= reach : target >= reach) {
+            return end_coordinate;
         }
-        if (end_coordinate.y >= y0 && end_coordinate.y <= y1) {
-            if (end_coordinate.x <= x0) {
-                if ((distance = std::abs(x0 - end_coordinate.x)) < minimum_distance) {
-                    minimum_distance = distance;
-                    border_coordinate.x = x0;
-                    border_coordinate.y = end_coordinate.y;
-                    continue;
-                }   
-            }
-            if (end_coordinate.x >= x1) {
-                if ((distance = std::abs(x1 - end_coordinate.x)) < minimum_distance) {
-                    minimum_distance = distance;
-                    border_coordinate.x = x1;
-                    border_coordinate.y = end_coordinate.y;
-                    continue;
-                }
-            }
+        // the border of the cell containing the reach, on the side the dog comes from
+        const double next = forward ? std::round(reach) - 0.5 : std::round(reach) + 0.5;
+        if (forward ? next <= pos : next >= pos) {
+            // the reach doesn't leave the current cell
+            pos = reach;
+            return position;
         }
+        pos = next;
     }
-    return border_coordinate;
 }
 
-void GameSession::LoadRoadMap() {
-    auto& roads = map_->GetRoads();
-    for (const auto& road : roads) {
-        auto start = road.GetStart();
-        auto end = road.GetEnd();
-        if (road.IsHorizontal()) {
-            if (start.x > end.x) {
-                std::swap(start, end);
-            }
-            for (auto x = start.x; x <= end.x; x++) {
-                road_map_.emplace(Point{.x = x, .y = start.y}, &road);
-            }
+double GameSession::FindRoadReach(const DogCoordinate& position, bool along_x, bool forward) const {
+    // a dog on a cell border belongs to the next cell in the direction of movement
+    auto to_cell = [forward](double pos) {
+        return static_cast<Coord>(forward ? std::floor(pos + 0.5) : std::ceil(pos - 0.5));
+    };
+    const auto cell_x = along_x ? to_cell(position.x) : static_cast<Coord>(std::round(position.x));
+    const auto cell_y = along_x ? static_cast<Coord>(std::round(position.y)) : to_cell(position.y);
+
+    // every road of the cell covers the cell center with its half-width around it,
+    // so the roads whose band holds the dog form one stretch along the axis
+    double reach = along_x ? position.x : position.y;
+    map_->GetRoadIndex().ForEachRoad(cell_x, cell_y, [&](const RoadBounds& road) {
+        if (along_x ? (position.y < road.y0 || position.y > road.y1) : (position.x < road.x0 || position.x > road.x1)) {
+            return;
         }
-        if (road.IsVertical()) {
-            if (start.y > end.y) {
-                std::swap(start, end);
-            }
-            for (auto y = start.y; y <= end.y; y++) {
-                road_map_.emplace(Point{ .x = start.x, .y = y }, &road);
-            }
+        if (along_x) {
+            reach = forward ? std::max(reach, road.x1) : std::min(reach, road.x0);
         }
-    }
+        else {
+            reach = forward ? std::max(reach, road.y1) : std::min(reach, road.y0);
+        }
+    });
+    return reach;
 }
 
-std::string Dog::GetDirection()
+std::string Dog::GetDirection() const
 {
     switch (dog_direction_) {
         case DOG_DIRECTION::NORTH:
@@ -525,31 +753,31 @@ void Dog::Direction(DOG_MOVE dog_move, double speed) {
     switch (dog_move) {
         case DOG_MOVE::LEFT:
         {
-            dog_speed_ = { -1 * speed, 0 };
+            SetSpeed({ -1 * speed, 0 });
             SetDirection(DOG_DIRECTION::WEST);
             break;
         }
         case DOG_MOVE::RIGHT:
         {
-            dog_speed_ = { speed, 0 };
+            SetSpeed({ speed, 0 });
             SetDirection(DOG_DIRECTION::EAST);
             break;
         }
         case DOG_MOVE::UP:
         {
-            dog_speed_ = { 0, -1 * speed };
+            SetSpeed({ 0, -1 * speed });
             SetDirection(DOG_DIRECTION::NORTH);
             break;
         }
         case DOG_MOVE::DOWN:
         {
-            dog_speed_ = { 0, speed };
+            SetSpeed({ 0, speed });
             SetDirection(DOG_DIRECTION::SOUTH);
             break;
         }
         case DOG_MOVE::STAND:
         {
-            dog_speed_ = { 0, 0 };
+            SetSpeed({ 0, 0 });
             break;
         }
     }
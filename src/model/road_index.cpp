@@ -0,0 +1,66 @@
+#include <model/road_index.h>
+#include <model/model.h>
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+
+namespace model {
+
+RoadIndex::RoadIndex(const std::vector<Road>& roads) {
+    for (const auto& road : roads) {
+        auto start = road.GetStart();
+        auto end = road.GetEnd();
+        auto x0 = std::min(start.x, end.x);
+        auto x1 = std::max(start.x, end.x);
+        auto y0 = std::min(start.y, end.y);
+        auto y1 = std::max(start.y, end.y);
+        RoadBounds bounds {
+            .x0 = x0 - ROAD_HALF_WIDTH,
+            .x1 = x1 + ROAD_HALF_WIDTH,
+            .y0 = y0 - ROAD_HALF_WIDTH,
+            .y1 = y1 + ROAD_HALF_WIDTH
+        };
+        if (road.IsHorizontal()) {
+            horizontal_.push_back(Interval{ .line = y0, .from = x0, .to = x1, .max_to = x1, .bounds = bounds });
+        }
+        else {
+            vertical_.push_back(Interval{ .line = x0, .from = y0, .to = y1, .max_to = y1, .bounds = bounds });
+        }
+    }
+    Finalize(horizontal_);
+    Finalize(vertical_);
+}
+
+void RoadIndex::Finalize(Intervals& intervals) {
+    std::sort(
+        intervals.begin(),
+        intervals.end(),
+        [](const Interval& lhs, const Interval& rhs) {
+            return std::tie(lhs.line, lhs.from) < std::tie(rhs.line, rhs.from);
+        }
+    );
+    for (size_t i = 1; i < intervals.size(); ++i) {
+        if (intervals[i].line == intervals[i - 1].line) {
+            intervals[i].max_to = std::max(intervals[i].to, intervals[i - 1].max_to);
+        }
+    }
+    intervals.shrink_to_fit();
+}
+
+RoadIndex::Intervals::const_iterator RoadIndex::UpperBound(const Intervals& intervals, int line, int pos) {
+    return std::upper_bound(
+        intervals.begin(),
+        intervals.end(),
+        std::make_pair(line, pos),
+        [](const std::pair<int, int>& key, const Interval& interval) {
+            return key < std::make_pair(interval.line, interval.from);
+        }
+    );
+}
+
+size_t RoadIndex::GetMemoryUsage() const noexcept {
+    return sizeof(*this) + (horizontal_.capacity() + vertical_.capacity()) * sizeof(Interval);
+}
+
+}  // namespace model
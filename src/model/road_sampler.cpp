@@ -0,0 +1,75 @@
+#include <model/road_sampler.h>
+#include <model/model.h>
+
+#include <cmath>
+
+namespace model {
+
+RoadSampler::RoadSampler(const std::vector<Road>& roads) {
+    segments_.reserve(roads.size());
+    std::vector<double> weights;
+    weights.reserve(roads.size());
+    double total = 0;
+    for (const auto& road : roads) {
+        auto start = road.GetStart();
+        auto end = road.GetEnd();
+        segments_.push_back(Segment{
+            .x = static_cast<double>(start.x),
+            .y = static_cast<double>(start.y),
+            .dx = static_cast<double>(end.x - start.x),
+            .dy = static_cast<double>(end.y - start.y)
+        });
+        weights.push_back(std::abs(segments_.back().dx) + std::abs(segments_.back().dy));
+        total += weights.back();
+    }
+
+    const size_t count = segments_.size();
+    probability_.assign(count, 1.0);
+    alias_.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        alias_[i] = static_cast<uint32_t>(i);
+    }
+    // a map made of zero-length roads only falls back to a uniform choice
+    if (count == 0 || total == 0) {
+        return;
+    }
+
+    // Vose's alias method: every column holds at most two roads
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (size_t i = 0; i < count; ++i) {
+        weights[i] *= static_cast<double>(count) / total;
+        (weights[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+    }
+    while (!small.empty() && !large.empty()) {
+        auto less = small.back();
+        small.pop_back();
+        auto more = large.back();
+        probability_[less] = weights[less];
+        alias_[less] = more;
+        weights[more] -= 1.0 - weights[less];
+        if (weights[more] < 1.0) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    // the rest are full columns up to rounding errors
+    for (auto i : small) {
+        probability_[i] = 1.0;
+    }
+    for (auto i : large) {
+        probability_[i] = 1.0;
+    }
+}
+
+RoadPoint RoadSampler::Sample(RandomEngine& engine) const noexcept {
+    auto column = engine.NextIndex(segments_.size());
+    const auto& segment = segments_[engine.NextDouble() < probability_[column] ? column : alias_[column]];
+    const double offset = engine.NextDouble();
+    return RoadPoint{
+        .x = segment.x + segment.dx * offset,
+        .y = segment.y + segment.dy * offset
+    };
+}
+
+}  // namespace model
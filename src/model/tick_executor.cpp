@@ -0,0 +1,152 @@
+#include <model/tick_executor.h>
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+namespace model {
+
+TickExecutor::TickExecutor(unsigned threads_count) {
+    threads_count = std::max(1u, threads_count);
+    for (unsigned i = 0; i < threads_count; ++i) {
+        queues_.emplace_back(std::make_unique<Queue>());
+    }
+    // queue 0 belongs to the thread calling Run
+    workers_.reserve(threads_count - 1);
+    for (unsigned i = 1; i < threads_count; ++i) {
+        workers_.emplace_back([this, i] {
+            WorkerLoop(i);
+        });
+    }
+}
+
+TickExecutor::~TickExecutor() {
+    {
+        std::lock_guard lock{mutex_};
+        stop_ = true;
+    }
+    start_cv_.notify_all();
+    // std::jthread joins on destruction
+    workers_.clear();
+}
+
+void TickExecutor::Run(std::vector<Cost>& costs, const Task& task) {
+    if (costs.empty()) {
+        return;
+    }
+
+    {
+        std::lock_guard lock{mutex_};
+        task_ = &task;
+        costs_ = &costs;
+        remaining_ = costs.size();
+        exception_ = nullptr;
+    }
+    Distribute(costs);
+    {
+        std::lock_guard lock{mutex_};
+        ++generation_;
+    }
+    start_cv_.notify_all();
+
+    // the calling thread works too
+    Execute(0);
+
+    std::unique_lock lock{mutex_};
+    done_cv_.wait(lock, [this] {
+        return remaining_ == 0;
+    });
+    task_ = nullptr;
+    costs_ = nullptr;
+    if (exception_) {
+        std::rethrow_exception(std::exchange(exception_, nullptr));
+    }
+}
+
+void TickExecutor::Distribute(const std::vector<Cost>& costs) {
+    // longest processing time first: the heaviest task goes to the least loaded queue
+    order_.resize(costs.size());
+    std::iota(order_.begin(), order_.end(), size_t{0});
+    std::stable_sort(order_.begin(), order_.end(), [&costs](size_t lhs, size_t rhs) {
+        return costs[lhs] > costs[rhs];
+    });
+
+    loads_.assign(queues_.size(), Cost{0});
+    for (auto task_index : order_) {
+        auto queue_index = static_cast<size_t>(std::min_element(loads_.begin(), loads_.end()) - loads_.begin());
+        // unmeasured tasks still have to be spread over the queues
+        loads_[queue_index] += std::max(costs[task_index], Cost{1});
+        std::lock_guard lock{queues_[queue_index]->mutex};
+        queues_[queue_index]->tasks.push_back(task_index);
+    }
+}
+
+void TickExecutor::WorkerLoop(size_t queue_index) {
+    size_t seen_generation = 0;
+    while (true) {
+        {
+            std::unique_lock lock{mutex_};
+            start_cv_.wait(lock, [&] {
+                return stop_ || generation_ != seen_generation;
+            });
+            if (stop_) {
+                return;
+            }
+            seen_generation = generation_;
+        }
+        Execute(queue_index);
+    }
+}
+
+void TickExecutor::Execute(size_t queue_index) {
+    size_t task_index;
+    while (PopOwn(queue_index, task_index) || Steal(queue_index, task_index)) {
+        auto start = std::chrono::steady_clock::now();
+        try {
+            (*task_)(task_index);
+        }
+        catch (...) {
+            std::lock_guard lock{mutex_};
+            if (!exception_) {
+                exception_ = std::current_exception();
+            }
+        }
+        auto measured = std::chrono::duration_cast<Cost>(std::chrono::steady_clock::now() - start);
+
+        // every task owns its own cost entry
+        auto& cost = (*costs_)[task_index];
+        cost = cost == Cost{0} ? measured : (cost * 3 + measured) / 4;
+
+        std::lock_guard lock{mutex_};
+        if (--remaining_ == 0) {
+            done_cv_.notify_all();
+        }
+    }
+}
+
+bool TickExecutor::PopOwn(size_t queue_index, size_t& task_index) {
+    auto& queue = *queues_[queue_index];
+    std::lock_guard lock{queue.mutex};
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task_index = queue.tasks.front();
+    queue.tasks.pop_front();
+    return true;
+}
+
+bool TickExecutor::Steal(size_t queue_index, size_t& task_index) {
+    for (size_t i = 1; i < queues_.size(); ++i) {
+        auto& queue = *queues_[(queue_index + i) % queues_.size()];
+        std::lock_guard lock{queue.mutex};
+        if (!queue.tasks.empty()) {
+            // take the lightest task from the tail of the victim's queue
+            task_index = queue.tasks.back();
+            queue.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace model
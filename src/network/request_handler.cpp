@@ -5,7 +5,7 @@ namespace http_handler {
 
 RequestHandler::RequestHandler(model::Game& game, const Args& program_args, Strand api_strand) : 
     file_response{program_args.www_root}, 
-    api_response{*program_args.application, program_args.use_tick_api}, 
+    api_response{*program_args.application, program_args.use_tick_api, *program_args.scheduler}, 
     api_strand_{api_strand} {}
 
 std::string RequestHandler::UrlPathDecode(const std::string_view& path) {
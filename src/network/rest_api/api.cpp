@@ -39,6 +39,20 @@ API_TYPE Api::RestApiHandlerType(const std::string_view& request_target) {
     }
 }
 
+bool Api::IsConcurrent(const StringRequest& req) const {
+    auto request_target = req.target();
+    if (req.method() == http::verb::post) {
+        // with the tick API the time stands still, so actions are applied at once in the simulation thread
+        return !use_tick_api_ && request_target.find("/api/v1/game/player/action"sv) == 0;
+    }
+    if (req.method() != http::verb::get && req.method() != http::verb::head) {
+        return false;
+    }
+    return request_target.find("/api/v1/maps"sv) == 0 ||
+           request_target.find("/api/v1/game/players"sv) == 0 ||
+           request_target.find("/api/v1/game/state"sv) == 0;
+}
+
 Response Api::MakeGetHeadResponse(const StringRequest& req) {
     
     const auto text_response = [&](http::status status, std::string text) {
@@ -222,7 +236,9 @@ Response Api::MakePostResponse(const StringRequest& req) {
         {
             // get state
             application::APPLICATION_ERROR app_error;
-            auto response = app_.Tick(req.body(), app_error);
+            auto response = app_.Tick(req.body(), app_error, [this](model::TimeDelta delta) {
+                scheduler_.Advance(delta);
+            });
             switch (app_error) {
                 case application::APPLICATION_ERROR::INVALID_ARGUMENT:
                 {
@@ -383,7 +399,10 @@ StringResponse Api::SetActionPlayer(const StringRequest& request) {
     return ExecuteAuthorized(
         request, 
         [&](const std::string& auth_token, application::APPLICATION_ERROR& app_error){
-            return app_.ActionPlayer(auth_token, app_error, request.body());
+            if (use_tick_api_) {
+                return app_.ActionPlayer(auth_token, app_error, request.body());
+            }
+            return app_.QueueActionPlayer(auth_token, app_error, request.body());
         }
     );
 }
@@ -0,0 +1,204 @@
+#include <scheduler.h>
+#include <logger/logger.h>
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <utility>
+
+namespace ticker {
+
+void Scheduler::AddTask(TaskConfig config, Task task) {
+    std::optional<size_t> lead;
+    if (!config.follows.empty()) {
+        auto it = std::find_if(tasks_.begin(), tasks_.end(), [&config](const TaskState& state) {
+            return state.config.name == config.follows;
+        });
+        if (it == tasks_.end()) {
+            throw std::invalid_argument("Task " + config.name + " follows unknown task " + config.follows);
+        }
+        // a follower of a follower runs after the same lead
+        lead = it->lead.value_or(static_cast<size_t>(it - tasks_.begin()));
+        auto& followers = tasks_[*lead].followers;
+        auto position = std::find_if(followers.begin(), followers.end(), [&](size_t follower) {
+            return tasks_[follower].config.priority > config.priority;
+        });
+        followers.insert(position, tasks_.size());
+    }
+
+    const auto period = config.period;
+    const auto max_period = config.max_period;
+    tasks_.push_back(TaskState{
+        .config = std::move(config),
+        .task = std::move(task),
+        .controller = TickRateController{period, max_period},
+        .lead = lead
+    });
+}
+
+void Scheduler::Start() {
+    net::dispatch(
+        strand_,
+        [self = shared_from_this()] {
+            const auto now = Clock::now();
+            for (size_t index = 0; index < self->tasks_.size(); ++index) {
+                auto& state = self->tasks_[index];
+                state.last_run = now;
+                // tasks without a period follow only the manual clock, the followers run with their lead
+                if (state.config.period == Clock::duration{0} || state.lead) {
+                    continue;
+                }
+                self->due_.push(Due{
+                    state.controller.Start(now + state.config.phase),
+                    state.config.priority,
+                    index
+                });
+            }
+            self->ScheduleNext();
+        }
+    );
+}
+
+void Scheduler::Advance(Duration delta) {
+    assert(strand_.running_in_this_thread());
+    if (delta <= Duration{0}) {
+        return;
+    }
+    if (!manual_started_) {
+        manual_started_ = true;
+        for (size_t index = 0; index < tasks_.size(); ++index) {
+            auto& state = tasks_[index];
+            state.last_run = manual_now_;
+            if (state.lead) {
+                continue;
+            }
+            due_.push(Due{manual_now_ + state.config.phase + state.config.period, state.config.priority, index});
+        }
+    }
+    manual_now_ += delta;
+    RunDue(manual_now_, false);
+}
+
+void Scheduler::ScheduleNext() {
+    assert(strand_.running_in_this_thread());
+    if (due_.empty()) {
+        return;
+    }
+    timer_.expires_at(due_.top().time);
+    timer_.async_wait(
+        [self = shared_from_this()](sys::error_code ec) {
+            self->OnTimer(ec);
+        }
+    );
+}
+
+void Scheduler::OnTimer(sys::error_code ec) {
+    assert(strand_.running_in_this_thread());
+    if (ec) {
+        return;
+    }
+    RunDue(Clock::now(), true);
+    ScheduleNext();
+}
+
+void Scheduler::RunDue(Clock::time_point now, bool real_time) {
+    // the due tasks are taken at once, so a task runs once even if its next due has passed already
+    running_.clear();
+    while (!due_.empty() && due_.top().time <= now) {
+        running_.push_back(due_.top());
+        due_.pop();
+    }
+
+    for (const auto& due : running_) {
+        auto& state = tasks_[due.task];
+        const auto start = real_time ? Clock::now() : now;
+        // the followers' cost counts in the load, so the period stretches for the whole run
+        const auto cost = RunWithFollowers(state, start, real_time);
+
+        Clock::time_point next;
+        if (real_time) {
+            next = state.controller.OnTick(due.time, start, cost);
+        }
+        else if (state.config.period == Clock::duration{0}) {
+            next = now;
+        }
+        else {
+            // the missed due times of the manual clock are skipped as well
+            const auto period = state.config.period;
+            next = due.time + ((now - due.time) / period + 1) * period;
+        }
+        due_.push(Due{next, due.priority, due.task});
+    }
+}
+
+Scheduler::Clock::duration Scheduler::RunTask(TaskState& state, Clock::time_point now) {
+    // the truncated remainder goes to the next run, so no time is lost at short periods
+    const auto delta = duration_cast<Duration>(now - state.last_run);
+    state.last_run += delta;
+
+    const auto start = Clock::now();
+    try {
+        state.task(delta);
+    }
+    catch (const std::exception& ex) {
+        boost::json::object log_data;
+        log_data["task"] = state.config.name;
+        log_data["error"] = ex.what();
+        LOG().print(log_data, "scheduled task error");
+    }
+    const auto cost = Clock::now() - start;
+
+    state.costs.Add(cost);
+    if (state.config.slow_cost != Clock::duration{0} && cost > state.config.slow_cost) {
+        boost::json::object log_data;
+        log_data["task"] = state.config.name;
+        log_data["costMs"] = duration<double, std::milli>(cost).count();
+        log_data["deltaMs"] = duration<double, std::milli>(delta).count();
+        LOG().print(log_data, "slow task");
+    }
+    return cost;
+}
+
+Scheduler::Clock::duration Scheduler::RunWithFollowers(TaskState& state, Clock::time_point now, bool real_time) {
+    auto cost = RunTask(state, now);
+    for (auto follower : state.followers) {
+        cost += RunTask(tasks_[follower], real_time ? Clock::now() : now);
+    }
+    return cost;
+}
+
+std::vector<Scheduler::TaskStats> Scheduler::TakeStats() {
+    const auto now = Clock::now();
+    std::vector<TaskStats> stats;
+    stats.reserve(tasks_.size());
+    for (auto& state : tasks_) {
+        stats.push_back(TaskStats{
+            .name = state.config.name,
+            .costs = std::exchange(state.costs, model::DurationHistogram{}),
+            // the lead is added before its followers, so its stats are taken already
+            .tick = state.lead ? stats[*state.lead].tick : state.controller.TakeStats(now)
+        });
+    }
+    return stats;
+}
+
+void Scheduler::LogStats() {
+    for (const auto& task : TakeStats()) {
+        const auto to_ms = [](Clock::duration time) {
+            return duration<double, std::milli>(time).count();
+        };
+        boost::json::object log_data;
+        log_data["task"] = task.name;
+        log_data["runs"] = task.costs.Count();
+        log_data["costMs"] = to_ms(task.costs.Total());
+        log_data["p50CostMs"] = to_ms(task.costs.Percentile(0.5));
+        log_data["p99CostMs"] = to_ms(task.costs.Percentile(0.99));
+        log_data["maxCostMs"] = to_ms(task.costs.Max());
+        log_data["tickRate"] = task.tick.tick_rate;
+        log_data["overruns"] = task.tick.overruns;
+        log_data["lagMs"] = to_ms(task.tick.lag);
+        log_data["periodMs"] = to_ms(task.tick.period);
+        LOG().print(log_data, "task stats");
+    }
+}
+
+}  // namespace ticker
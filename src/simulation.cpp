@@ -0,0 +1,58 @@
+#include <simulation.h>
+
+#include <logger/logger.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace simulation {
+
+SimulationThread::SimulationThread(std::optional<unsigned> cpu)
+    : work_(net::make_work_guard(ioc_))
+    , strand_(net::make_strand(ioc_))
+    , cpu_(cpu) {
+}
+
+SimulationThread::~SimulationThread() {
+    Stop();
+}
+
+void SimulationThread::Start() {
+    thread_ = std::jthread([this] {
+        ioc_.run();
+    });
+    if (cpu_) {
+        Pin(*cpu_);
+    }
+}
+
+void SimulationThread::Stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    // commands queued before Stop still run, the pending timers are abandoned
+    work_.reset();
+    net::post(strand_, [this] {
+        ioc_.stop();
+    });
+    thread_.join();
+}
+
+void SimulationThread::Pin(unsigned cpu) {
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    if (pthread_setaffinity_np(thread_.native_handle(), sizeof(cpu_set), &cpu_set) != 0) {
+        boost::json::object log_data;
+        log_data["cpu"] = cpu;
+        LOG().print(log_data, "simulation thread is not pinned");
+    }
+#else
+    (void)cpu;
+#endif
+}
+
+}  // namespace simulation
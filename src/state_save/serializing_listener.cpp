@@ -15,28 +15,20 @@ using OutputArchive = boost::archive::text_oarchive;
 
 SerializingListener::SerializingListener(
     std::shared_ptr<application::Application> application,
-    const std::string& save_file, 
-    milliseconds save_period) 
+    const std::string& save_file) 
     : application_(std::move(application))
     , save_file_(save_file)
-    , save_period_(save_period) 
 {
-    time_since_save_ = 0ms;
 }
 
-void SerializingListener::OnTick(milliseconds time_delta_ms) {
-    time_since_save_ += time_delta_ms;
-    if (time_since_save_ >= save_period_) {
-        boost::json::object log_data;
-        log_data["time since save"] = std::to_string(time_since_save_.count());
-        log_data["save period"] = std::to_string(save_period_.count());
-        LOG().print(
-            log_data,
-            "Periodic save game state"        
-        );
-        Save();
-        time_since_save_ = 0ms;
-    }
+void SerializingListener::PeriodicSave(model::TimeDelta time_since_save) {
+    boost::json::object log_data;
+    log_data["time since save"] = std::to_string(std::chrono::duration_cast<milliseconds>(time_since_save).count());
+    LOG().print(
+        log_data,
+        "Periodic save game state"        
+    );
+    Save();
 }
 
 void SerializingListener::Load() {
@@ -50,6 +42,9 @@ void SerializingListener::Load() {
         serialization::ApplicationRepr repr;
         input_archive >> repr;
         repr.Restore(*application_);
+        // restored players read their state before the first tick
+        application_->MarkPlayersChanged();
+        application_->PublishState();
     }
     catch (const std::exception& ex) {
         log_data["error"] = ex.what();
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <model.h>
+
+using namespace std::literals;
+
+namespace {
+
+// test hook: every heap allocation of the test binary goes through the replaced operator new below
+std::atomic<size_t> allocations_count {0};
+
+size_t AllocationsCount() {
+    return allocations_count.load(std::memory_order_relaxed);
+}
+
+void* CountedAllocate(std::size_t size, std::size_t alignment) {
+    allocations_count.fetch_add(1, std::memory_order_relaxed);
+    // aligned_alloc wants the size to be a multiple of the alignment
+    const auto rounded = (std::max<std::size_t>(size, 1) + alignment - 1) / alignment * alignment;
+    if (void* ptr = std::aligned_alloc(alignment, rounded)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void CountedRelease(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+}  // namespace
+
+// all the replaceable forms go through the same pair, so every pointer is released by the function that matches its allocation
+void* operator new(std::size_t size) {
+    return CountedAllocate(size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size) {
+    return CountedAllocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return CountedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return CountedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return CountedAllocate(size, alignof(std::max_align_t));
+    }
+    catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return CountedAllocate(size, alignof(std::max_align_t));
+    }
+    catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* ptr) noexcept {
+    CountedRelease(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    CountedRelease(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    CountedRelease(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    CountedRelease(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    CountedRelease(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    CountedRelease(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    CountedRelease(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+    CountedRelease(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    CountedRelease(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    CountedRelease(ptr);
+}
+
+SCENARIO("Game session tick allocations") {
+    model::Game game(model::LootGeneratorConfig{1s, 0.5});
+    model::Map map(model::Map::Id{"map1"s}, "Map 1"s);
+    map.AddRoad({model::Road::HORIZONTAL, {0, 0}, 40});
+    map.AddRoad({model::Road::VERTICAL, {40, 0}, 40});
+    map.AddRoad({model::Road::HORIZONTAL, {0, 40}, 40});
+    map.AddRoad({model::Road::VERTICAL, {0, 0}, 40});
+    map.AddOffice(model::Office{model::Office::Id{"o1"s}, {20, 0}, {0, 0}});
+    map.AddOffice(model::Office{model::Office::Id{"o2"s}, {0, 20}, {0, 0}});
+    map.SetDogSpeed(3.0);
+    map.SetBagCapacity(3);
+    map.AddLootScore(10);
+    map.AddLootScore(20);
+    game.AddMap(map);
+    game.SetRandomizeSpawnPoints(true);
+    game.SetRandomSeed(17);
+
+    auto session = game.AddGameSession(model::Map::Id{"map1"s});
+    std::vector<model::Dog*> dogs;
+    for (int i = 0; i < 300; ++i) {
+        dogs.push_back(session->AddDog("dog"s + std::to_string(i)));
+    }
+
+    const model::DOG_MOVE moves[] = {model::DOG_MOVE::RIGHT, model::DOG_MOVE::DOWN, model::DOG_MOVE::LEFT, model::DOG_MOVE::UP};
+    auto tick = [&](int step) {
+        for (size_t i = 0; i < dogs.size(); ++i) {
+            session->MoveDog(dogs[i]->GetId(), moves[(i + step / 5) % 4]);
+        }
+        session->Tick(200ms);
+    };
+
+    GIVEN("a warmed up session") {
+        for (int step = 0; step < 500; ++step) {
+            tick(step);
+        }
+
+        WHEN("the session keeps ticking") {
+            const auto before = AllocationsCount();
+            for (int step = 500; step < 600; ++step) {
+                tick(step);
+            }
+            const auto allocations = AllocationsCount() - before;
+            THEN("the tick doesn't touch the heap") {
+                CHECK(allocations == 0);
+            }
+        }
+    }
+}
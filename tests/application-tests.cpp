@@ -1,4 +1,5 @@
 #include <cmath>
+#include <cstdlib>
 #include <catch2/catch_test_macros.hpp>
 
 #include <application.h>
@@ -20,4 +21,67 @@ SCENARIO("Check application::check_token function") {
             CHECK(application::check_token("Bearer asdfghjklzxcvbnmqwertyuiop123456"));
         }        
 	}
-}
\ No newline at end of file
+}
+
+SCENARIO("Published state without ticks") {
+    // the application keeps the retired players in Postgres, as the server it takes the database from GAME_DB_URL
+    const char* db_url = std::getenv("GAME_DB_URL");
+    if (db_url == nullptr) {
+        WARN("GAME_DB_URL is not set, the published state is not checked");
+        return;
+    }
+
+    GIVEN("an application with one map") {
+        model::Game game(model::LootGeneratorConfig{1s, 0.5});
+        model::Map map(model::Map::Id{"map1"s}, "Map 1"s);
+        map.AddRoad({model::Road::HORIZONTAL, {0, 0}, 100});
+        map.SetDogSpeed(1.0);
+        map.SetBagCapacity(3);
+        map.AddLootScore(10);
+        game.AddMap(map);
+        application::Application app{game, 1, db_url};
+        app.PublishState();
+
+        application::APPLICATION_ERROR app_error;
+        const auto join = [&](const std::string& name) {
+            auto response = boost::json::parse(app.Join(R"({"userName": ")" + name + R"(", "mapId": "map1"})", app_error));
+            REQUIRE(app_error == application::APPLICATION_ERROR::APPLICATION_NO_ERROR);
+            return "Bearer "s + response.at("authToken").as_string().c_str();
+        };
+        const auto state_dogs = [&](const std::string& auth) {
+            auto state = boost::json::parse(app.GetState(auth, app_error));
+            REQUIRE(app_error == application::APPLICATION_ERROR::APPLICATION_NO_ERROR);
+            return state.at("players").as_object();
+        };
+
+        WHEN("a player joins") {
+            const auto rex = join("Rex"s);
+            THEN("the state and the players show it before a tick") {
+                CHECK(state_dogs(rex).size() == 1);
+                auto players = boost::json::parse(app.GetPlayers(rex, app_error));
+                CHECK(players.as_object().size() == 1);
+            }
+
+            AND_WHEN("another player joins the same session") {
+                join("Lucky"s);
+                THEN("the first player sees both dogs and both names before a tick") {
+                    CHECK(state_dogs(rex).size() == 2);
+                    auto players = boost::json::parse(app.GetPlayers(rex, app_error));
+                    CHECK(players.as_object().size() == 2);
+                }
+            }
+
+            AND_WHEN("the player moves") {
+                app.ActionPlayer(rex, app_error, R"({"move": "R"})");
+                REQUIRE(app_error == application::APPLICATION_ERROR::APPLICATION_NO_ERROR);
+                THEN("the state shows the move before a tick") {
+                    const auto dogs = state_dogs(rex);
+                    REQUIRE(dogs.size() == 1);
+                    const auto& dog = dogs.begin()->value();
+                    CHECK(dog.at("dir").as_string() == "R");
+                    CHECK(dog.at("speed").as_array().at(0).as_double() == 1.0);
+                }
+            }
+        }
+    }
+}
@@ -1,7 +1,9 @@
 #define _USE_MATH_DEFINES
 
+#include <algorithm>
 #include <cmath>
 #include <functional>
+#include <random>
 #include <sstream>
 
 #include <catch2/catch_test_macros.hpp>
@@ -99,6 +101,98 @@ public:
     }
 };
 
+// reference O(G x I) search, the broadphase must reproduce it event for event
+std::vector<collision_detector::GatheringEvent> FindGatherEventsBruteForce(
+        const collision_detector::ItemGathererProvider& provider) {
+    std::vector<collision_detector::GatheringEvent> events;
+    for (size_t gatherer_id = 0; gatherer_id < provider.GatherersCount(); ++gatherer_id) {
+        auto gatherer = provider.GetGatherer(gatherer_id);
+        if (gatherer.start_pos.x == gatherer.end_pos.x && gatherer.start_pos.y == gatherer.end_pos.y) {
+            continue;
+        }
+        for (size_t item_id = 0; item_id < provider.ItemsCount(); ++item_id) {
+            auto item = provider.GetItem(item_id);
+            auto result = collision_detector::TryCollectPoint(gatherer.start_pos, gatherer.end_pos, item.position);
+            if (result.IsCollected(gatherer.width + item.width)) {
+                events.push_back({item_id, gatherer_id, result.sq_distance, result.proj_ratio});
+            }
+        }
+    }
+    collision_detector::SortGatherEvents(events);
+    return events;
+}
+
+VectorItemGathererProvider MakeRandomProvider(size_t items_count, size_t gatherers_count,
+                                              double map_size, double max_step, unsigned seed) {
+    std::mt19937 generator{seed};
+    std::uniform_real_distribution<double> coord{0, map_size};
+    std::uniform_real_distribution<double> step{-max_step, max_step};
+    std::uniform_int_distribution<int> grid_coord{0, static_cast<int>(map_size)};
+    std::vector<collision_detector::Item> items;
+    for (size_t i = 0; i < items_count; ++i) {
+        // offices have integer positions and a bigger width than loots
+        if (i % 10 == 0) {
+            items.push_back({{static_cast<double>(grid_coord(generator)), static_cast<double>(grid_coord(generator))}, 0.5});
+        }
+        else {
+            items.push_back({{coord(generator), coord(generator)}, 0.0});
+        }
+    }
+    std::vector<collision_detector::Gatherer> gatherers;
+    for (size_t i = 0; i < gatherers_count; ++i) {
+        geom::Point2D start{coord(generator), coord(generator)};
+        geom::Point2D end = start;
+        // dogs move along one axis, some of them stand still
+        if (i % 3 == 0) {
+            end.x += step(generator);
+        }
+        else if (i % 3 == 1) {
+            end.y += step(generator);
+        }
+        gatherers.push_back({start, end, 0.6});
+    }
+    return VectorItemGathererProvider{items, gatherers};
+}
+
+}
+
+SCENARIO("Collision detection broadphase") {
+    auto check_same_events = [](const VectorItemGathererProvider& provider) {
+        auto expected = FindGatherEventsBruteForce(provider);
+        auto events = collision_detector::FindGatherEvents(provider);
+        REQUIRE(events.size() == expected.size());
+        for (size_t i = 0; i < events.size(); ++i) {
+            INFO("event: " << i);
+            CHECK(events[i].item_id == expected[i].item_id);
+            CHECK(events[i].gatherer_id == expected[i].gatherer_id);
+            CHECK(events[i].sq_distance == expected[i].sq_distance);
+            CHECK(events[i].time == expected[i].time);
+        }
+    };
+
+    WHEN("dogs and loots are spread over a big map") {
+        check_same_events(MakeRandomProvider(2000, 2000, 200, 5, 1));
+    }
+    WHEN("the map is crowded") {
+        check_same_events(MakeRandomProvider(500, 500, 10, 3, 2));
+    }
+    WHEN("gatherers make long moves") {
+        check_same_events(MakeRandomProvider(300, 100, 50, 100, 3));
+    }
+    WHEN("all items lie on one line") {
+        std::vector<collision_detector::Item> items;
+        std::vector<collision_detector::Gatherer> gatherers;
+        for (int i = 0; i < 100; ++i) {
+            items.push_back({{i * 0.5, 0.0}, 0.0});
+            gatherers.push_back({{i * 0.5 - 0.3, 0.2}, {i * 0.5 + 0.7, 0.2}, 0.6});
+        }
+        check_same_events(VectorItemGathererProvider{items, gatherers});
+    }
+    WHEN("all items share one point") {
+        std::vector<collision_detector::Item> items(50, {{3.0, 3.0}, 0.0});
+        std::vector<collision_detector::Gatherer> gatherers(10, {{0.0, 3.0}, {5.0, 3.0}, 0.6});
+        check_same_events(VectorItemGathererProvider{items, gatherers});
+    }
 }
 
 SCENARIO("Collision detection") {
@@ -181,4 +275,87 @@ SCENARIO("Collision detection") {
             CHECK(events.empty());
         }
     }
-}
\ No newline at end of file
+}
+SCENARIO("Batched point collection") {
+    GIVEN("a block of points around a segment") {
+        std::mt19937 generator{5};
+        std::uniform_real_distribution<double> coord{-3, 13};
+        std::uniform_real_distribution<double> width{0, 0.5};
+        std::vector<double> xs, ys, widths;
+        // odd count, so the vector loop leaves a tail for the scalar one
+        for (int i = 0; i < 1001; ++i) {
+            xs.push_back(coord(generator));
+            ys.push_back(coord(generator) / 4);
+            widths.push_back(width(generator));
+        }
+        geom::Point2D a{0, 0};
+        geom::Point2D b{10, 1};
+
+        THEN("hits match TryCollectPoint for every point") {
+            std::vector<collision_detector::CollectHit> hits;
+            collision_detector::CollectPoints(a, b, 0.6, xs.data(), ys.data(), widths.data(), xs.size(), hits);
+            std::vector<collision_detector::CollectHit> expected;
+            for (size_t i = 0; i < xs.size(); ++i) {
+                auto result = collision_detector::TryCollectPoint(a, b, {xs[i], ys[i]});
+                if (result.IsCollected(0.6 + widths[i])) {
+                    expected.push_back({i, result.sq_distance, result.proj_ratio});
+                }
+            }
+            REQUIRE(!expected.empty());
+            REQUIRE(hits.size() == expected.size());
+            for (size_t i = 0; i < hits.size(); ++i) {
+                CHECK(hits[i].index == expected[i].index);
+                CHECK(hits[i].sq_distance == expected[i].sq_distance);
+                CHECK(hits[i].proj_ratio == expected[i].proj_ratio);
+            }
+        }
+    }
+}
+
+namespace {
+
+// provider without virtual functions, used through the ItemGathererSource concept
+struct ArrayProvider {
+    std::vector<collision_detector::Item> items;
+    std::vector<collision_detector::Gatherer> gatherers;
+
+    size_t ItemsCount() const {
+        return items.size();
+    }
+    const collision_detector::Item& GetItem(size_t idx) const {
+        return items[idx];
+    }
+    size_t GatherersCount() const {
+        return gatherers.size();
+    }
+    const collision_detector::Gatherer& GetGatherer(size_t idx) const {
+        return gatherers[idx];
+    }
+};
+
+static_assert(collision_detector::ItemGathererSource<ArrayProvider>);
+static_assert(collision_detector::ContiguousItemGathererSource<collision_detector::ItemGatherer>);
+
+}  // namespace
+
+SCENARIO("Compile-time item gatherer providers") {
+    auto provider = MakeRandomProvider(400, 400, 40, 4, 11);
+    ArrayProvider array_provider;
+    collision_detector::ItemGatherer item_gatherer;
+    for (size_t i = 0; i < provider.ItemsCount(); ++i) {
+        array_provider.items.push_back(provider.GetItem(i));
+        item_gatherer.Add(provider.GetItem(i));
+    }
+    for (size_t i = 0; i < provider.GatherersCount(); ++i) {
+        array_provider.gatherers.push_back(provider.GetGatherer(i));
+        item_gatherer.Add(provider.GetGatherer(i));
+    }
+    const collision_detector::ItemGathererProvider& virtual_provider = provider;
+    auto expected = collision_detector::FindGatherEvents(virtual_provider);
+
+    THEN("every provider kind gives the same events") {
+        REQUIRE(!expected.empty());
+        CHECK_THAT(collision_detector::FindGatherEvents(array_provider), EqualsRange(expected, CompareEvents()));
+        CHECK_THAT(collision_detector::FindGatherEvents(item_gatherer), EqualsRange(expected, CompareEvents()));
+    }
+}
@@ -0,0 +1,138 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <game_record.h>
+
+using namespace std::literals;
+
+namespace {
+
+model::Map MakeMap() {
+    model::Map map(model::Map::Id{"map1"s}, "Map 1"s);
+    map.AddRoad({model::Road::HORIZONTAL, {0, 0}, 20});
+    map.AddRoad({model::Road::VERTICAL, {0, 0}, 20});
+    map.AddRoad({model::Road::VERTICAL, {20, 0}, 20});
+    map.AddOffice(model::Office{model::Office::Id{"o1"s}, {20, 0}, {0, 0}});
+    map.SetDogSpeed(2.0);
+    map.SetBagCapacity(3);
+    map.AddLootScore(10);
+    return map;
+}
+
+model::Game MakeGame() {
+    model::Game game(model::LootGeneratorConfig{500ms, 0.8});
+    game.AddMap(MakeMap());
+    game.SetRandomizeSpawnPoints(true);
+    return game;
+}
+
+struct DogState {
+    std::string name;
+    model::DogCoordinate position;
+    int score;
+    size_t bag;
+
+    bool operator==(const DogState&) const = default;
+};
+
+std::vector<DogState> GetDogs(model::Game& game) {
+    std::vector<DogState> dogs;
+    for (const auto& session : game.GetGameSessions()) {
+        for (const auto& dog : session->GetDogs()) {
+            dogs.push_back(DogState{dog.GetName(), dog.GetCoordinate(), dog.GetScore(), dog.GetBag().size()});
+        }
+    }
+    return dogs;
+}
+
+}  // namespace
+
+SCENARIO("Game record and replay") {
+    std::stringstream record;
+    model::GameRecorder recorder{record};
+    auto game = MakeGame();
+    game.SetRandomSeed(42);
+    game.SetRecorder(&recorder);
+
+    auto session = game.AddGameSession(model::Map::Id{"map1"s});
+    auto rex = session->AddDog("Rex"s);
+    auto pluto = session->AddDog("Pluto"s);
+    session->MoveDog(rex->GetId(), model::DOG_MOVE::RIGHT);
+    session->GetMoveQueue()->Push(model::DogAction{pluto->GetId(), model::DOG_MOVE::DOWN});
+    for (int i = 0; i < 50; ++i) {
+        game.Tick(137ms);
+    }
+    session->MoveDog(rex->GetId(), model::DOG_MOVE::LEFT);
+    auto spike = session->AddDog("Spike"s);
+    session->MoveDog(spike->GetId(), model::DOG_MOVE::UP);
+    game.Tick(2500us);
+    session->DeleteDog(pluto->GetId());
+    for (int i = 0; i < 50; ++i) {
+        game.Tick(91ms);
+    }
+    recorder.Flush();
+
+    WHEN("the record is replayed into a game with the same config") {
+        auto replayed_game = MakeGame();
+        model::GameRecordReader reader{record};
+        model::GameReplay replay{replayed_game, reader.ReadHeader()};
+        model::RecordEvent event;
+        while (reader.Next(event)) {
+            replay.Apply(event);
+        }
+
+        THEN("the game ends in the same state") {
+            CHECK(replay.GetTicks() == 101);
+            CHECK(replay.GetGameTime() == 50 * 137ms + 2500us + 50 * 91ms);
+            CHECK(GetDogs(replayed_game) == GetDogs(game));
+            REQUIRE(replayed_game.GetGameSessions().size() == 1);
+            CHECK(replayed_game.GetGameSessions().front()->GetLoots().Size() == session->GetLoots().Size());
+        }
+    }
+
+    WHEN("the record is cut in the middle of an event") {
+        auto text = record.str();
+        std::stringstream cut{text.substr(0, text.size() - 3)};
+        auto replayed_game = MakeGame();
+        model::GameRecordReader reader{cut};
+        model::GameReplay replay{replayed_game, reader.ReadHeader()};
+        model::RecordEvent event;
+
+        THEN("reading fails") {
+            CHECK_THROWS_AS([&] {
+                while (reader.Next(event)) {
+                    replay.Apply(event);
+                }
+            }(), std::runtime_error);
+        }
+    }
+
+    WHEN("a move of the record is corrupt") {
+        std::stringstream corrupt;
+        model::GameRecorder corrupt_recorder{corrupt};
+        corrupt_recorder.WriteHeader(model::RecordHeader{.random_seed = 42});
+        corrupt_recorder.RecordJoin(corrupt_recorder.RecordNewSession(model::Map::Id{"map1"s}), rex->GetId(), "Rex"s);
+        corrupt_recorder.RecordMove(rex->GetId(), model::DOG_MOVE::UP);
+        corrupt_recorder.Flush();
+        auto text = corrupt.str();
+        text.back() = static_cast<char>(200);
+        std::stringstream input{text};
+        model::GameRecordReader reader{input};
+        reader.ReadHeader();
+        model::RecordEvent event;
+
+        THEN("reading fails at the move") {
+            CHECK(reader.Next(event));
+            CHECK(reader.Next(event));
+            CHECK_THROWS_AS(reader.Next(event), std::runtime_error);
+        }
+    }
+
+    THEN("recording can't start after the first session") {
+        model::GameRecorder other{record};
+        CHECK_THROWS_AS(game.SetRecorder(&other), std::logic_error);
+    }
+}
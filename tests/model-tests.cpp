@@ -1,10 +1,28 @@
+#include <algorithm>
 #include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
 #include <catch2/catch_test_macros.hpp>
 
 #include <model.h>
 
 using namespace std::literals;
 
+namespace {
+
+model::Map MakeMap() {
+	model::Map map(model::Map::Id{"map1"s}, "Map 1"s);
+	map.AddRoad({model::Road::HORIZONTAL, {0, 0}, 10});
+	map.AddRoad({model::Road::VERTICAL, {10, 0}, 10});
+	map.SetDogSpeed(1.0);
+	map.SetBagCapacity(3);
+	map.AddLootScore(10);
+	return map;
+}
+
+}  // namespace
+
 SCENARIO("Load game model") {
 	using model::Game;
 
@@ -15,4 +33,422 @@ SCENARIO("Load game model") {
 		}
 
 	}
-}
\ No newline at end of file
+}
+
+SCENARIO("Game session tick") {
+	model::Game game(model::LootGeneratorConfig{1s, 0.5});
+	game.AddMap(MakeMap());
+	auto session = game.AddGameSession(model::Map::Id{"map1"s});
+
+	GIVEN("dogs in a session") {
+		auto dog = session->AddDog("Rex"s);
+		auto other = session->AddDog("Pluto"s);
+
+		WHEN("dog moves along the road") {
+			session->MoveDog(dog->GetId(), model::DOG_MOVE::RIGHT);
+			game.Tick(2500ms);
+			THEN("it keeps moving and the standing dog stays put") {
+				CHECK(dog->GetCoordinate() == model::DogCoordinate{2.5, 0.0});
+				CHECK(dog->GetStartPos() == model::DogCoordinate{0.0, 0.0});
+				CHECK(dog->GetSpeed() == model::DogSpeed{1.0, 0.0});
+				CHECK(other->GetCoordinate() == model::DogCoordinate{0.0, 0.0});
+				CHECK(dog->GetLifetime() == 2500ms);
+				CHECK(dog->GetStayTime() == 0ms);
+				CHECK(other->GetStayTime() == 2500ms);
+			}
+		}
+
+		WHEN("dog runs off the road") {
+			session->MoveDog(dog->GetId(), model::DOG_MOVE::UP);
+			game.Tick(1000ms);
+			THEN("it stops on the road border") {
+				CHECK(dog->GetCoordinate() == model::DogCoordinate{0.0, -0.4});
+				CHECK(dog->IsStanding());
+			}
+		}
+
+		WHEN("the first dog is deleted") {
+			auto other_id = other->GetId();
+			session->DeleteDog(dog->GetId());
+			THEN("the other dog keeps its state") {
+				auto found = session->FindDog(other_id);
+				REQUIRE(found != nullptr);
+				CHECK(found->GetName() == "Pluto"s);
+				CHECK(found->GetCoordinate() == model::DogCoordinate{0.0, 0.0});
+				CHECK(session->GetDogs().Size() == 1);
+			}
+			THEN("pointers to other dogs stay valid") {
+				CHECK(session->FindDog(other_id) == other);
+				CHECK(session->FindDog("Pluto"s) == other);
+				CHECK(session->FindDog("Rex"s) == nullptr);
+			}
+			AND_WHEN("a new dog joins and the game ticks") {
+				auto bim = session->AddDog("Bim"s);
+				session->MoveDog(bim->GetId(), model::DOG_MOVE::RIGHT);
+				game.Tick(1000ms);
+				THEN("it moves on its own") {
+					CHECK(bim->GetCoordinate() == model::DogCoordinate{1.0, 0.0});
+					CHECK(other->GetCoordinate() == model::DogCoordinate{0.0, 0.0});
+				}
+			}
+		}
+	}
+}
+
+SCENARIO("Game session shards") {
+	model::Game game(model::LootGeneratorConfig{1s, 0.5});
+	auto map = MakeMap();
+	map.SetSessionMaxPlayers(2);
+	game.AddMap(std::move(map));
+	const model::Map::Id map_id{"map1"s};
+
+	GIVEN("a full session") {
+		auto first = game.AddGameSession(map_id);
+		auto rex = first->AddDog("Rex"s);
+		first->AddDog("Pluto"s);
+
+		THEN("no session has room for one more player") {
+			CHECK(game.FindGameSession(map_id) == nullptr);
+		}
+
+		WHEN("one more session is opened") {
+			auto second = game.AddGameSession(map_id);
+			auto bim = second->AddDog("Bim"s);
+			THEN("new players join the least loaded session") {
+				CHECK(game.FindGameSession(map_id) == second);
+				CHECK(game.GetGameSessions().size() == 2);
+			}
+			THEN("dogs are found in their own sessions") {
+				CHECK(game.FindDogSession(map_id, rex->GetId()) == first);
+				CHECK(game.FindDogSession(map_id, bim->GetId()) == second);
+			}
+			AND_WHEN("a player leaves the first session") {
+				first->DeleteDog(rex->GetId());
+				THEN("the first session accepts players again") {
+					CHECK(game.FindGameSession(map_id) == first);
+				}
+			}
+		}
+	}
+}
+
+SCENARIO("Loot pool") {
+	model::LootPool pool;
+	auto loot = [](uint32_t id, double x) {
+		return model::Loot{.id = model::Loot::Id{id}, .type = 0, .coordinate = {x, 0.0}};
+	};
+
+	GIVEN("loots on the map") {
+		auto first = pool.Spawn(loot(1, 1.0));
+		auto second = pool.Spawn(loot(2, 2.0));
+		auto third = pool.Spawn(loot(3, 3.0));
+		REQUIRE(pool.Size() == 3);
+
+		WHEN("a loot is picked up") {
+			pool.PickUp(first);
+			THEN("it leaves the map but stays allocated") {
+				CHECK(pool.Size() == 2);
+				CHECK_FALSE(pool.IsOnMap(first));
+				CHECK(pool.IsOnMap(second));
+				CHECK(pool.IsOnMap(third));
+				CHECK(*pool.Get(first).id == 1u);
+				std::vector<uint32_t> ids;
+				for (const auto& on_map : pool) {
+					ids.push_back(*on_map.id);
+				}
+				std::sort(ids.begin(), ids.end());
+				CHECK(ids == std::vector<uint32_t>{2, 3});
+			}
+			AND_WHEN("it is released") {
+				pool.Release(first);
+				THEN("its cell is reused by the next loot") {
+					auto fourth = pool.Spawn(loot(4, 4.0));
+					CHECK(fourth == first);
+					CHECK(*pool.Get(fourth).id == 4u);
+					CHECK(pool.Size() == 3);
+				}
+			}
+		}
+	}
+}
+
+SCENARIO("Dog bag") {
+	model::Game game(model::LootGeneratorConfig{1s, 0.0});
+	auto map = MakeMap();
+	map.AddOffice(model::Office{model::Office::Id{"o1"s}, {10, 0}, {0, 0}});
+	game.AddMap(map);
+	auto session = game.AddGameSession(model::Map::Id{"map1"s});
+	auto dog = session->AddDog("Rex"s);
+	// AddDog spawns one loot at a random point, put another one on the way
+	session->SetLoots({model::Loot{.id = model::Loot::Id{100}, .type = 0, .coordinate = {2.0, 0.0}}});
+
+	WHEN("the dog runs over the loot") {
+		session->MoveDog(dog->GetId(), model::DOG_MOVE::RIGHT);
+		game.Tick(3000ms);
+		THEN("the loot moves to the bag") {
+			bool in_bag = false;
+			dog->ForEachLoot([&](const model::Loot& loot) {
+				in_bag = in_bag || *loot.id == 100u;
+			});
+			CHECK(in_bag);
+			for (const auto& loot : session->GetLoots()) {
+				CHECK(*loot.id != 100u);
+			}
+		}
+		AND_WHEN("the dog reaches the office") {
+			game.Tick(8000ms);
+			THEN("the bag is returned for score") {
+				CHECK(dog->GetBag().empty());
+				CHECK(dog->GetScore() >= 10);
+			}
+		}
+	}
+}
+
+SCENARIO("Dog movement doesn't depend on tick splitting") {
+	auto make_game = [] {
+		model::Game game(model::LootGeneratorConfig{1s, 0.0});
+		model::Map map(model::Map::Id{"map1"s}, "Map 1"s);
+		map.AddRoad({model::Road::HORIZONTAL, {0, 0}, 10});
+		map.AddRoad({model::Road::HORIZONTAL, {10, 0}, 20});
+		map.AddRoad({model::Road::HORIZONTAL, {5, 0}, 15});
+		map.AddRoad({model::Road::VERTICAL, {20, 0}, 10});
+		map.AddRoad({model::Road::VERTICAL, {3, -5}, 5});
+		map.AddRoad({model::Road::HORIZONTAL, {20, 10}, 16});
+		map.SetDogSpeed(1.5);
+		map.SetBagCapacity(3);
+		map.AddLootScore(10);
+		game.AddMap(map);
+		return game;
+	};
+	struct Start {
+		model::DogCoordinate position;
+		model::DOG_MOVE move;
+	};
+	const std::vector<Start> starts{
+		{{0.0, 0.0}, model::DOG_MOVE::RIGHT},
+		{{18.0, 0.3}, model::DOG_MOVE::LEFT},
+		{{3.0, 4.0}, model::DOG_MOVE::DOWN},
+		{{20.0, 1.0}, model::DOG_MOVE::DOWN},
+		{{3.2, 0.0}, model::DOG_MOVE::UP},
+		{{19.8, 10.0}, model::DOG_MOVE::LEFT},
+	};
+	auto make_dogs = [&](model::GameSession& session) {
+		std::vector<model::Dog*> dogs;
+		for (size_t i = 0; i < starts.size(); ++i) {
+			auto dog = session.AddDog("dog"s + std::to_string(i));
+			dog->SetCoordinate(starts[i].position);
+			session.MoveDog(dog->GetId(), starts[i].move);
+			dogs.push_back(dog);
+		}
+		return dogs;
+	};
+
+	auto coarse_game = make_game();
+	auto coarse_dogs = make_dogs(*coarse_game.AddGameSession(model::Map::Id{"map1"s}));
+	auto fine_game = make_game();
+	auto fine_dogs = make_dogs(*fine_game.AddGameSession(model::Map::Id{"map1"s}));
+
+	WHEN("one game ticks once and the other one ticks many times") {
+		coarse_game.Tick(20'000ms);
+		for (int i = 0; i < 2'000; ++i) {
+			fine_game.Tick(10ms);
+		}
+		THEN("dogs stop at the same points") {
+			for (size_t i = 0; i < starts.size(); ++i) {
+				INFO("dog: " << i);
+				CHECK(std::abs(coarse_dogs[i]->GetCoordinate().x - fine_dogs[i]->GetCoordinate().x) < 1e-9);
+				CHECK(std::abs(coarse_dogs[i]->GetCoordinate().y - fine_dogs[i]->GetCoordinate().y) < 1e-9);
+				CHECK(coarse_dogs[i]->IsStanding());
+				CHECK(fine_dogs[i]->IsStanding());
+			}
+		}
+		THEN("dogs pass junctions of adjoining roads") {
+			auto near = [](const model::DogCoordinate& l, const model::DogCoordinate& r) {
+				return std::abs(l.x - r.x) < 1e-9 && std::abs(l.y - r.y) < 1e-9;
+			};
+			CHECK(near(coarse_dogs[0]->GetCoordinate(), {20.4, 0.0}));
+			CHECK(near(coarse_dogs[1]->GetCoordinate(), {-0.4, 0.3}));
+			CHECK(near(coarse_dogs[2]->GetCoordinate(), {3.0, 5.4}));
+			CHECK(near(coarse_dogs[3]->GetCoordinate(), {20.0, 10.4}));
+			CHECK(near(coarse_dogs[4]->GetCoordinate(), {3.2, -5.4}));
+			CHECK(near(coarse_dogs[5]->GetCoordinate(), {15.6, 10.0}));
+		}
+	}
+
+	WHEN("the other game ticks at sub-millisecond steps") {
+		coarse_game.Tick(20'000ms);
+		for (int i = 0; i < 50'000; ++i) {
+			fine_game.Tick(400us);
+		}
+		THEN("no time is lost") {
+			for (size_t i = 0; i < starts.size(); ++i) {
+				INFO("dog: " << i);
+				CHECK(fine_dogs[i]->GetLifetime() == 20s);
+				CHECK(std::abs(coarse_dogs[i]->GetCoordinate().x - fine_dogs[i]->GetCoordinate().x) < 1e-9);
+				CHECK(std::abs(coarse_dogs[i]->GetCoordinate().y - fine_dogs[i]->GetCoordinate().y) < 1e-9);
+			}
+		}
+	}
+}
+
+SCENARIO("Dormant game session") {
+	model::Game game(model::LootGeneratorConfig{1s, 1.0});
+	game.AddMap(MakeMap());
+	auto session = game.AddGameSession(model::Map::Id{"map1"s});
+
+	GIVEN("a standing dog and its loot") {
+		auto dog = session->AddDog("dog"s);
+		REQUIRE(session->GetLoots().Size() == 1);
+		REQUIRE(session->IsDormant());
+
+		WHEN("the game ticks") {
+			game.Tick(1500ms);
+			THEN("times follow the session clock and no loot appears") {
+				CHECK(session->IsDormant());
+				CHECK(dog->GetLifetime() == 1500ms);
+				CHECK(dog->GetStayTime() == 1500ms);
+				CHECK(session->GetLoots().Size() == 1);
+			}
+		}
+
+		WHEN("the dog starts moving") {
+			game.Tick(500ms);
+			session->MoveDog(dog->GetId(), model::DOG_MOVE::RIGHT);
+			THEN("the session wakes up") {
+				CHECK_FALSE(session->IsDormant());
+				CHECK(dog->GetStayTime() == 0ms);
+			}
+
+			AND_WHEN("the dog runs into the end of the road") {
+				game.Tick(12'000ms);
+				THEN("it stops and its stay time starts from the stop") {
+					CHECK(dog->IsStanding());
+					CHECK(dog->GetLifetime() == 12'500ms);
+					CHECK(dog->GetStayTime() == 0ms);
+					game.Tick(700ms);
+					CHECK(dog->GetStayTime() == 700ms);
+				}
+			}
+		}
+
+		WHEN("a dog without a loot joins") {
+			session->RestoreDog(model::Dog::Id{7}, "puppy"s, {0.0, 0.0});
+			THEN("the loot generator may run again") {
+				CHECK_FALSE(session->IsDormant());
+			}
+		}
+	}
+}
+
+SCENARIO("Empty game sessions are reclaimed") {
+	model::Game game(model::LootGeneratorConfig{1s, 0.5});
+	game.AddMap(MakeMap());
+	game.SetSessionEmptyTime(10s);
+	const model::Map::Id map_id{"map1"s};
+
+	GIVEN("two sessions of the map") {
+		auto busy = game.AddGameSession(map_id);
+		auto dog = busy->AddDog("dog"s);
+		auto empty = game.AddGameSession(map_id);
+		auto puppy = empty->AddDog("puppy"s);
+		empty->DeleteDog(puppy->GetId());
+
+		WHEN("a session stays empty for less than the empty time") {
+			game.Tick(9'000ms);
+			THEN("it is kept") {
+				CHECK(game.GetGameSessions().size() == 2);
+				CHECK(empty->GetEmptyTime() == 9s);
+				CHECK(busy->GetEmptyTime() == 0ms);
+			}
+		}
+
+		WHEN("a session stays empty for the empty time") {
+			game.Tick(6'000ms);
+			game.Tick(6'000ms);
+			THEN("it is removed, the busy one is kept") {
+				REQUIRE(game.GetGameSessions().size() == 1);
+				CHECK(game.GetGameSessions().front().get() == busy);
+				CHECK(game.FindGameSession(map_id) == busy);
+				CHECK(game.FindDogSession(map_id, dog->GetId()) == busy);
+			}
+
+			AND_WHEN("the last player leaves") {
+				busy->DeleteDog(dog->GetId());
+				game.Tick(10'000ms);
+				THEN("the map has no sessions until the next join") {
+					CHECK(game.GetGameSessions().empty());
+					CHECK(game.FindGameSession(map_id) == nullptr);
+					auto session = game.AddGameSession(map_id);
+					CHECK(game.FindGameSession(map_id) == session);
+				}
+			}
+		}
+	}
+}
+
+SCENARIO("Game session version") {
+	model::Game game(model::LootGeneratorConfig{1s, 0.0});
+	game.AddMap(MakeMap());
+	auto session = game.AddGameSession(model::Map::Id{"map1"s});
+	auto dog = session->AddDog("dog"s);
+	const auto version = session->GetVersion();
+
+	WHEN("a dormant session ticks") {
+		game.Tick(100ms);
+		THEN("readers keep their copy") {
+			CHECK(session->GetVersion() == version);
+		}
+	}
+
+	WHEN("a dog moves and the session ticks") {
+		session->MoveDog(dog->GetId(), model::DOG_MOVE::RIGHT);
+		const auto moved_version = session->GetVersion();
+		game.Tick(100ms);
+		THEN("every change gives a new version") {
+			CHECK(moved_version != version);
+			CHECK(session->GetVersion() != moved_version);
+		}
+	}
+
+	WHEN("a dog leaves") {
+		session->DeleteDog(dog->GetId());
+		THEN("the version changes") {
+			CHECK(session->GetVersion() != version);
+		}
+	}
+}
+
+SCENARIO("Queued dog moves") {
+	model::Game game(model::LootGeneratorConfig{1s, 0.0});
+	game.AddMap(MakeMap());
+	auto session = game.AddGameSession(model::Map::Id{"map1"s});
+	auto dog = session->AddDog("dog"s);
+	auto puppy = session->AddDog("puppy"s);
+	REQUIRE(session->IsDormant());
+
+	WHEN("moves are queued from another thread") {
+		auto moves = session->GetMoveQueue();
+		std::thread writer([&] {
+			moves->Push(model::DogAction{dog->GetId(), model::DOG_MOVE::LEFT});
+			moves->Push(model::DogAction{puppy->GetId(), model::DOG_MOVE::DOWN});
+			moves->Push(model::DogAction{dog->GetId(), model::DOG_MOVE::RIGHT});
+		});
+		writer.join();
+
+		THEN("they wait for the tick and wake the session up") {
+			CHECK(dog->IsStanding());
+			CHECK_FALSE(session->IsDormant());
+		}
+
+		AND_WHEN("the game ticks") {
+			game.Tick(1000ms);
+			THEN("the last move of every dog is applied") {
+				CHECK(dog->GetCoordinate() == model::DogCoordinate{1.0, 0.0});
+				CHECK(dog->GetDirectionType() == model::DOG_DIRECTION::EAST);
+				CHECK(puppy->GetDirectionType() == model::DOG_DIRECTION::SOUTH);
+				CHECK(session->GetMoveQueue()->Empty());
+			}
+		}
+	}
+}
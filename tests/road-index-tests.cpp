@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <model.h>
+
+using namespace std::literals;
+
+namespace {
+
+using Bounds = std::tuple<double, double, double, double>;
+
+std::vector<Bounds> FindRoads(const model::RoadIndex& index, int x, int y) {
+    std::vector<Bounds> result;
+    index.ForEachRoad(x, y, [&](const model::RoadBounds& road) {
+        result.emplace_back(road.x0, road.x1, road.y0, road.y1);
+    });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+// reference lookup: every road whose cells contain (x, y)
+std::vector<Bounds> FindRoadsBruteForce(const std::vector<model::Road>& roads, int x, int y) {
+    std::vector<Bounds> result;
+    for (const auto& road : roads) {
+        auto x0 = std::min(road.GetStart().x, road.GetEnd().x);
+        auto x1 = std::max(road.GetStart().x, road.GetEnd().x);
+        auto y0 = std::min(road.GetStart().y, road.GetEnd().y);
+        auto y1 = std::max(road.GetStart().y, road.GetEnd().y);
+        if (x >= x0 && x <= x1 && y >= y0 && y <= y1) {
+            result.emplace_back(x0 - 0.4, x1 + 0.4, y0 - 0.4, y1 + 0.4);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<model::Road> GenerateRoads(size_t count, int map_size, unsigned seed) {
+    std::mt19937 generator{seed};
+    std::uniform_int_distribution<int> coord{0, map_size};
+    std::vector<model::Road> roads;
+    roads.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        model::Point start{coord(generator), coord(generator)};
+        if (i % 2 == 0) {
+            roads.emplace_back(model::Road::HORIZONTAL, start, coord(generator));
+        }
+        else {
+            roads.emplace_back(model::Road::VERTICAL, start, coord(generator));
+        }
+    }
+    return roads;
+}
+
+}  // namespace
+
+SCENARIO("Road index") {
+    GIVEN("crossing and overlapping roads") {
+        std::vector<model::Road> roads{
+            {model::Road::HORIZONTAL, {0, 0}, 10},
+            {model::Road::HORIZONTAL, {20, 0}, 5},
+            {model::Road::VERTICAL, {10, 0}, 10},
+            {model::Road::VERTICAL, {10, -5}, 2},
+            {model::Road::HORIZONTAL, {0, 10}, 10},
+        };
+        model::RoadIndex index{roads};
+
+        WHEN("cell is outside of roads") {
+            CHECK(FindRoads(index, 3, 3).empty());
+            CHECK(FindRoads(index, 21, 0).empty());
+        }
+        WHEN("cell is on a single road") {
+            CHECK(FindRoads(index, 2, 0) == std::vector<Bounds>{{-0.4, 10.4, -0.4, 0.4}});
+        }
+        WHEN("cell is on a crossing") {
+            CHECK(FindRoads(index, 10, 0) == FindRoadsBruteForce(roads, 10, 0));
+            CHECK(FindRoads(index, 10, 0).size() == 4);
+            CHECK(FindRoads(index, 10, 10).size() == 2);
+        }
+        WHEN("index is compared with a brute force lookup") {
+            for (int x = -2; x <= 22; ++x) {
+                for (int y = -7; y <= 12; ++y) {
+                    INFO("cell: " << x << ", " << y);
+                    REQUIRE(FindRoads(index, x, y) == FindRoadsBruteForce(roads, x, y));
+                }
+            }
+        }
+    }
+
+    GIVEN("a random map") {
+        auto roads = GenerateRoads(500, 100, 42);
+        model::RoadIndex index{roads};
+        THEN("every cell lookup matches brute force") {
+            for (int x = 0; x <= 100; ++x) {
+                for (int y = 0; y <= 100; ++y) {
+                    INFO("cell: " << x << ", " << y);
+                    REQUIRE(FindRoads(index, x, y) == FindRoadsBruteForce(roads, x, y));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Road index lookup benchmark", "[.][benchmark]") {
+    constexpr size_t ROADS_COUNT = 20'000;
+    constexpr int MAP_SIZE = 10'000;
+    auto roads = GenerateRoads(ROADS_COUNT, MAP_SIZE, 7);
+
+    model::RoadIndex index{roads};
+    WARN("roads: " << index.GetRoadsCount() << ", index memory: " << index.GetMemoryUsage() << " bytes");
+
+    std::mt19937 generator{13};
+    std::uniform_int_distribution<size_t> road_dist{0, roads.size() - 1};
+    std::vector<model::Point> cells;
+    for (size_t i = 0; i < 1024; ++i) {
+        cells.push_back(roads[road_dist(generator)].GetStart());
+    }
+
+    BENCHMARK("build index") {
+        return model::RoadIndex{roads};
+    };
+
+    BENCHMARK("1024 lookups") {
+        size_t found = 0;
+        for (const auto& cell : cells) {
+            index.ForEachRoad(cell.x, cell.y, [&](const model::RoadBounds&) {
+                ++found;
+            });
+        }
+        return found;
+    };
+}
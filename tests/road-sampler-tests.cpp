@@ -0,0 +1,110 @@
+#include <cmath>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <model.h>
+
+using namespace std::literals;
+
+SCENARIO("Road sampler") {
+    GIVEN("a short and a long road") {
+        std::vector<model::Road> roads{
+            {model::Road::HORIZONTAL, {0, 0}, 10},
+            {model::Road::VERTICAL, {20, 0}, 30},
+        };
+        model::RoadSampler sampler{roads};
+
+        WHEN("points are sampled") {
+            model::RandomEngine engine{42};
+            constexpr int SAMPLES = 40'000;
+            int on_long_road = 0;
+            for (int i = 0; i < SAMPLES; ++i) {
+                auto point = sampler.Sample(engine);
+                if (point.x == 20.0) {
+                    CHECK((point.y >= 0.0 && point.y <= 30.0));
+                    ++on_long_road;
+                }
+                else {
+                    CHECK(point.y == 0.0);
+                    CHECK((point.x >= 0.0 && point.x <= 10.0));
+                }
+            }
+            THEN("roads are chosen proportionally to their length") {
+                CHECK(std::abs(static_cast<double>(on_long_road) / SAMPLES - 0.75) < 0.02);
+            }
+        }
+
+        WHEN("engines have the same seed") {
+            model::RandomEngine first{7};
+            model::RandomEngine second{7};
+            THEN("they produce the same points") {
+                for (int i = 0; i < 100; ++i) {
+                    auto a = sampler.Sample(first);
+                    auto b = sampler.Sample(second);
+                    REQUIRE(a.x == b.x);
+                    REQUIRE(a.y == b.y);
+                }
+            }
+        }
+    }
+
+    GIVEN("zero-length roads only") {
+        std::vector<model::Road> roads{
+            {model::Road::HORIZONTAL, {1, 1}, 1},
+            {model::Road::VERTICAL, {5, 5}, 5},
+        };
+        model::RoadSampler sampler{roads};
+        model::RandomEngine engine{1};
+        THEN("every road can still be chosen") {
+            bool first = false;
+            bool second = false;
+            for (int i = 0; i < 100; ++i) {
+                auto point = sampler.Sample(engine);
+                first = first || point.x == 1.0;
+                second = second || point.x == 5.0;
+            }
+            CHECK(first);
+            CHECK(second);
+        }
+    }
+}
+
+SCENARIO("Seeded game sessions") {
+    auto make_game = [] {
+        model::Game game(model::LootGeneratorConfig{1s, 0.5});
+        model::Map map(model::Map::Id{"map1"s}, "Map 1"s);
+        map.AddRoad({model::Road::HORIZONTAL, {0, 0}, 40});
+        map.AddRoad({model::Road::VERTICAL, {40, 0}, 30});
+        map.SetDogSpeed(1.0);
+        map.SetBagCapacity(3);
+        map.AddLootScore(10);
+        map.AddLootScore(20);
+        game.AddMap(map);
+        game.SetRandomizeSpawnPoints(true);
+        game.SetRandomSeed(2024);
+        return game;
+    };
+
+    GIVEN("two games with the same seed") {
+        auto first = make_game();
+        auto second = make_game();
+        auto first_session = first.AddGameSession(model::Map::Id{"map1"s});
+        auto second_session = second.AddGameSession(model::Map::Id{"map1"s});
+        auto first_dog = first_session->AddDog("Rex"s);
+        auto second_dog = second_session->AddDog("Rex"s);
+        first.Tick(5000ms);
+        second.Tick(5000ms);
+
+        THEN("dogs spawn and loots appear at the same points") {
+            CHECK(first_dog->GetCoordinate() == second_dog->GetCoordinate());
+            REQUIRE(first_session->GetLoots().Size() == second_session->GetLoots().Size());
+            auto it = second_session->GetLoots().begin();
+            for (const auto& loot : first_session->GetLoots()) {
+                CHECK(loot.type == it->type);
+                CHECK(loot.coordinate == it->coordinate);
+                ++it;
+            }
+        }
+    }
+}
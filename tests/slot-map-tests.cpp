@@ -0,0 +1,80 @@
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <slot_map.h>
+
+using namespace std::literals;
+
+SCENARIO("Slot map") {
+    model::SlotMap<std::string> slots;
+
+    GIVEN("three values") {
+        auto a = slots.Emplace("a"s);
+        auto b = slots.Emplace("b"s);
+        auto c = slots.Emplace("c"s);
+        auto b_ptr = slots.Get(b);
+        auto c_ptr = slots.Get(c);
+
+        THEN("values are found by their handles") {
+            CHECK(slots.Size() == 3);
+            CHECK(*slots.Get(a) == "a"s);
+            CHECK(*b_ptr == "b"s);
+        }
+
+        WHEN("a value is erased") {
+            REQUIRE(slots.Erase(a));
+            THEN("its handle becomes stale and other values stay in place") {
+                CHECK(slots.Get(a) == nullptr);
+                CHECK_FALSE(slots.Erase(a));
+                CHECK(slots.Get(b) == b_ptr);
+                CHECK(slots.Get(c) == c_ptr);
+                CHECK(slots.Size() == 2);
+            }
+            AND_WHEN("a new value is added") {
+                auto d = slots.Emplace("d"s);
+                THEN("it reuses the free slot with a new generation") {
+                    CHECK(d.index == a.index);
+                    CHECK(d.generation != a.generation);
+                    CHECK(slots.Get(a) == nullptr);
+                    CHECK(*slots.Get(d) == "d"s);
+                }
+            }
+        }
+
+        WHEN("the values are iterated") {
+            slots.Erase(b);
+            std::vector<std::string> values(slots.begin(), slots.end());
+            THEN("free slots are skipped") {
+                CHECK(values == std::vector{"a"s, "c"s});
+            }
+        }
+
+        WHEN("the last values are erased and the map is compacted") {
+            slots.Erase(c);
+            slots.Erase(b);
+            slots.Compact();
+            THEN("trailing free slots are dropped") {
+                CHECK(slots.Capacity() == 1);
+                CHECK(slots.FreeCount() == 0);
+                CHECK(*slots.Get(a) == "a"s);
+                CHECK(slots.Get(b) == nullptr);
+                CHECK(slots.Emplace("e"s).index == 1);
+            }
+
+            AND_WHEN("values are emplaced into the dropped slots again") {
+                auto e = slots.Emplace("e"s);
+                auto f = slots.Emplace("f"s);
+                THEN("the stale handles of these slots still find nothing") {
+                    REQUIRE(e.index == b.index);
+                    REQUIRE(f.index == c.index);
+                    CHECK(slots.Get(b) == nullptr);
+                    CHECK(slots.Get(c) == nullptr);
+                    CHECK(*slots.Get(e) == "e"s);
+                    CHECK(*slots.Get(f) == "f"s);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,165 @@
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <model.h>
+
+using namespace std::literals;
+
+SCENARIO("Tick executor") {
+    using model::TickExecutor;
+
+    GIVEN("an executor with several threads") {
+        TickExecutor executor{4};
+
+        WHEN("tasks are run") {
+            std::vector<TickExecutor::Cost> costs(100);
+            std::vector<std::atomic<int>> calls(costs.size());
+            executor.Run(costs, [&](size_t index) {
+                ++calls[index];
+                if (index % 10 == 0) {
+                    std::this_thread::sleep_for(1ms);
+                }
+            });
+
+            THEN("every task is executed exactly once and its cost is measured") {
+                for (size_t i = 0; i < calls.size(); ++i) {
+                    INFO("task: " << i);
+                    CHECK(calls[i] == 1);
+                    CHECK(costs[i] > TickExecutor::Cost{0});
+                }
+            }
+
+            AND_WHEN("tasks are run again") {
+                executor.Run(costs, [&](size_t index) {
+                    ++calls[index];
+                });
+                THEN("every task is executed once more") {
+                    for (size_t i = 0; i < calls.size(); ++i) {
+                        INFO("task: " << i);
+                        CHECK(calls[i] == 2);
+                    }
+                }
+            }
+        }
+
+        WHEN("a task throws") {
+            std::vector<TickExecutor::Cost> costs(10);
+            std::atomic<int> calls{0};
+            THEN("the exception is rethrown after all tasks are done") {
+                CHECK_THROWS_AS(
+                    executor.Run(costs, [&](size_t index) {
+                        ++calls;
+                        if (index == 3) {
+                            throw std::runtime_error("tick failed");
+                        }
+                    }),
+                    std::runtime_error
+                );
+                CHECK(calls == 10);
+            }
+        }
+    }
+
+    GIVEN("a game with several sessions") {
+        model::Game game(model::LootGeneratorConfig{1s, 0.5});
+        game.SetTickThreads(4);
+        for (int i = 0; i < 8; ++i) {
+            model::Map map(model::Map::Id{"map"s + std::to_string(i)}, "Map"s);
+            map.AddRoad({model::Road::HORIZONTAL, {0, 0}, 100});
+            map.SetDogSpeed(1.0);
+            map.SetBagCapacity(3);
+            map.AddLootScore(10);
+            game.AddMap(map);
+        }
+        std::vector<model::Dog*> dogs;
+        for (const auto& map : game.GetMaps()) {
+            auto session = game.AddGameSession(map.GetId());
+            auto dog = session->AddDog("Rex"s);
+            session->MoveDog(dog->GetId(), model::DOG_MOVE::RIGHT);
+            dogs.push_back(dog);
+        }
+
+        WHEN("the game is ticked") {
+            game.Tick(1000ms);
+            THEN("every session is ticked before Tick returns") {
+                for (auto dog : dogs) {
+                    CHECK(dog->GetCoordinate() == model::DogCoordinate{1.0, 0.0});
+                }
+            }
+        }
+    }
+
+    GIVEN("a large session split into regions and the same session ticked in one thread") {
+        auto make_game = [] {
+            model::Game game(model::LootGeneratorConfig{1s, 0.5});
+            model::Map map(model::Map::Id{"map1"s}, "Map 1"s);
+            for (int i = 0; i <= 40; i += 10) {
+                map.AddRoad({model::Road::HORIZONTAL, {0, i}, 40});
+                map.AddRoad({model::Road::VERTICAL, {i, 0}, 40});
+            }
+            map.AddOffice(model::Office{model::Office::Id{"o1"s}, {20, 0}, {0, 0}});
+            map.AddOffice(model::Office{model::Office::Id{"o2"s}, {10, 30}, {0, 0}});
+            map.SetDogSpeed(3.0);
+            map.SetBagCapacity(2);
+            map.AddLootScore(10);
+            game.AddMap(map);
+            game.SetRandomizeSpawnPoints(true);
+            game.SetRandomSeed(5);
+            return game;
+        };
+        auto parallel_game = make_game();
+        parallel_game.SetTickThreads(4);
+        parallel_game.SetSessionPartitionMinDogs(100);
+        auto serial_game = make_game();
+
+        auto make_dogs = [](model::Game& game) {
+            auto session = game.AddGameSession(model::Map::Id{"map1"s});
+            std::vector<model::Dog*> dogs;
+            for (int i = 0; i < 400; ++i) {
+                dogs.push_back(session->AddDog("dog"s + std::to_string(i)));
+            }
+            return std::pair{session, dogs};
+        };
+        auto [parallel_session, parallel_dogs] = make_dogs(parallel_game);
+        auto [serial_session, serial_dogs] = make_dogs(serial_game);
+
+        WHEN("both games are ticked with the same actions") {
+            const model::DOG_MOVE moves[] = {model::DOG_MOVE::RIGHT, model::DOG_MOVE::DOWN, model::DOG_MOVE::LEFT, model::DOG_MOVE::UP};
+            for (int step = 0; step < 300; ++step) {
+                for (size_t i = 0; i < parallel_dogs.size(); ++i) {
+                    if ((i + step) % 7 == 0) {
+                        parallel_session->MoveDog(parallel_dogs[i]->GetId(), moves[(i * 3 + step) % 4]);
+                        serial_session->MoveDog(serial_dogs[i]->GetId(), moves[(i * 3 + step) % 4]);
+                    }
+                }
+                parallel_game.Tick(150ms);
+                serial_game.Tick(150ms);
+            }
+            THEN("dogs, bags and scores are the same") {
+                int scores = 0;
+                for (size_t i = 0; i < parallel_dogs.size(); ++i) {
+                    INFO("dog: " << i);
+                    REQUIRE(parallel_dogs[i]->GetCoordinate() == serial_dogs[i]->GetCoordinate());
+                    REQUIRE(parallel_dogs[i]->GetScore() == serial_dogs[i]->GetScore());
+                    std::vector<uint32_t> parallel_bag;
+                    std::vector<uint32_t> serial_bag;
+                    parallel_dogs[i]->ForEachLoot([&](const model::Loot& loot) {
+                        parallel_bag.push_back(*loot.id);
+                    });
+                    serial_dogs[i]->ForEachLoot([&](const model::Loot& loot) {
+                        serial_bag.push_back(*loot.id);
+                    });
+                    REQUIRE(parallel_bag == serial_bag);
+                    scores += parallel_dogs[i]->GetScore();
+                }
+                CHECK(scores > 0);
+                CHECK(parallel_session->GetLoots().Size() == serial_session->GetLoots().Size());
+            }
+        }
+    }
+}
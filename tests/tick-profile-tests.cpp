@@ -0,0 +1,142 @@
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <model.h>
+
+using namespace std::literals;
+
+SCENARIO("Duration histogram") {
+    using model::DurationHistogram;
+
+    GIVEN("a histogram of short samples and one long sample") {
+        DurationHistogram histogram;
+        for (int i = 0; i < 100; ++i) {
+            histogram.Add(3us);
+        }
+        histogram.Add(5ms);
+
+        THEN("it counts the samples, their total and the max") {
+            CHECK(histogram.Count() == 101);
+            CHECK(histogram.Total() == 300us + 5ms);
+            CHECK(histogram.Max() == 5ms);
+        }
+
+        THEN("a percentile is the upper bound of its power of two bucket, not above the max") {
+            CHECK(histogram.Percentile(0.5) == 4us);
+            CHECK(histogram.Percentile(0.99) == 4us);
+            CHECK(histogram.Percentile(1.0) == 5ms);
+        }
+
+        WHEN("another histogram is merged") {
+            DurationHistogram other;
+            other.Add(10s);
+            histogram.Merge(other);
+            THEN("a sample beyond the last bucket is kept in it") {
+                CHECK(histogram.Count() == 102);
+                CHECK(histogram.GetBuckets().back() == 1);
+                CHECK(histogram.Percentile(1.0) == 10s);
+            }
+        }
+    }
+
+    GIVEN("an empty histogram") {
+        DurationHistogram histogram;
+        THEN("its percentiles are zero") {
+            CHECK(histogram.Percentile(0.99) == DurationHistogram::Clock::duration{0});
+        }
+    }
+}
+
+SCENARIO("Phase timer") {
+    using model::TickPhase;
+
+    GIVEN("the times of a previous tick") {
+        model::TickPhaseTimes times;
+        times[TickPhase::EVENTS] = 1s;
+
+        WHEN("a timer starts") {
+            model::PhaseTimer timer{times};
+            THEN("the times start from zero") {
+                CHECK(times.Total() == model::TickPhaseTimes::Clock::duration{0});
+            }
+
+            AND_WHEN("a phase is lapped twice and a part of it is reassigned") {
+                timer.Lap(TickPhase::NARROWPHASE);
+                timer.Lap(TickPhase::NARROWPHASE);
+                const auto lapped = times[TickPhase::NARROWPHASE];
+                timer.Reassign(TickPhase::NARROWPHASE, TickPhase::BROADPHASE, lapped + 1s);
+                THEN("no more than the lapped time moves and the total stays") {
+                    CHECK(times[TickPhase::NARROWPHASE] == model::TickPhaseTimes::Clock::duration{0});
+                    CHECK(times[TickPhase::BROADPHASE] == lapped);
+                    CHECK(times.Total() == lapped);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Slow session ticks") {
+    GIVEN("a game with a moving dog in one session and an empty session") {
+        model::Game game(model::LootGeneratorConfig{1s, 0.5});
+        model::Map map(model::Map::Id{"map1"s}, "Map 1"s);
+        map.AddRoad({model::Road::HORIZONTAL, {0, 0}, 100});
+        map.SetDogSpeed(1.0);
+        map.SetBagCapacity(3);
+        map.AddLootScore(10);
+        game.AddMap(map);
+        game.SetSessionEmptyTime(10s);
+
+        auto empty_session = game.AddGameSession(model::Map::Id{"map1"s});
+        auto session = game.AddGameSession(model::Map::Id{"map1"s});
+        auto dog = session->AddDog("Rex"s);
+        session->MoveDog(dog->GetId(), model::DOG_MOVE::RIGHT);
+        REQUIRE(empty_session->GetId() != session->GetId());
+
+        std::vector<model::SlowSessionTick> slow_ticks;
+        auto handler = [&slow_ticks](const model::SlowSessionTick& tick) {
+            slow_ticks.push_back(tick);
+        };
+
+        WHEN("every tick is slower than the threshold") {
+            game.SetSlowTickHandler(model::TickPhaseTimes::Clock::duration{0}, handler);
+            game.Tick(100ms);
+            THEN("the ticked session is reported with its phases, the dormant one is not") {
+                REQUIRE(slow_ticks.size() == 1);
+                CHECK(slow_ticks[0].session_id == session->GetId());
+                CHECK(*slow_ticks[0].map_id == "map1"s);
+                CHECK(slow_ticks[0].dogs == 1);
+                CHECK(slow_ticks[0].loots == session->GetLoots().Size());
+                CHECK(slow_ticks[0].times.Total() == session->GetLastTickTimes().Total());
+            }
+        }
+
+        WHEN("no tick reaches the threshold") {
+            game.SetSlowTickHandler(1h, handler);
+            game.Tick(100ms);
+            THEN("nothing is reported") {
+                CHECK(slow_ticks.empty());
+            }
+        }
+
+        WHEN("the game is ticked and the session with the dog is reclaimed") {
+            game.Tick(100ms);
+            game.Tick(100ms);
+            session->DeleteDog(dog->GetId());
+            for (int i = 0; i < 3; ++i) {
+                game.Tick(5s);
+            }
+            REQUIRE(game.GetGameSessions().empty());
+
+            THEN("the profile keeps the ticks of the reclaimed session") {
+                const auto profile = game.TakeTickProfile();
+                CHECK(profile.ticks.Count() >= 2);
+                for (const auto& phase : profile.phases) {
+                    CHECK(phase.Count() == profile.ticks.Count());
+                }
+                CHECK(game.TakeTickProfile().ticks.Count() == 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#include <chrono>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <tick_rate_controller.h>
+
+using namespace std::literals;
+using ticker::TickRateController;
+
+SCENARIO("Tick rate controller") {
+    using Clock = TickRateController::Clock;
+    const Clock::time_point start{};
+
+    GIVEN("a fixed rate controller") {
+        TickRateController controller{100ms};
+        auto deadline = controller.Start(start);
+        REQUIRE(deadline == start + 100ms);
+
+        WHEN("ticks start late and take time") {
+            auto next = controller.OnTick(deadline, deadline + 5ms, 30ms);
+
+            THEN("the next deadline does not drift") {
+                CHECK(next == start + 200ms);
+                CHECK(controller.GetPeriod() == 100ms);
+                auto stats = controller.TakeStats(deadline + 35ms);
+                CHECK(stats.overruns == 0);
+                CHECK(stats.lag == 5ms);
+            }
+        }
+
+        WHEN("a tick takes longer than the period") {
+            auto next = controller.OnTick(deadline, deadline, 250ms);
+
+            THEN("the missed deadlines are skipped and the overrun is counted") {
+                CHECK(next == deadline + 250ms);
+                CHECK(controller.TakeStats(next).overruns == 1);
+            }
+        }
+
+        WHEN("the ticks are always overloaded") {
+            for (int i = 0; i < 20; ++i) {
+                deadline = controller.OnTick(deadline, deadline, 99ms);
+            }
+
+            THEN("the period stays fixed") {
+                CHECK(controller.GetPeriod() == 100ms);
+            }
+        }
+    }
+
+    GIVEN("an adaptive controller") {
+        TickRateController controller{100ms, 200ms};
+        auto deadline = controller.Start(start);
+
+        WHEN("the ticks take the whole period") {
+            for (int i = 0; i < 20; ++i) {
+                deadline = controller.OnTick(deadline, deadline, controller.GetPeriod() - 1ms);
+            }
+
+            THEN("the period grows up to the max period") {
+                CHECK(controller.GetPeriod() == 200ms);
+            }
+
+            AND_WHEN("the load goes down") {
+                for (int i = 0; i < 20; ++i) {
+                    deadline = controller.OnTick(deadline, deadline, 10ms);
+                }
+
+                THEN("the period returns to the base period") {
+                    CHECK(controller.GetPeriod() == 100ms);
+                }
+            }
+        }
+
+        THEN("the tick rate is measured") {
+            for (int i = 0; i < 10; ++i) {
+                deadline = controller.OnTick(deadline, deadline, 10ms);
+            }
+            auto stats = controller.TakeStats(start + 1s);
+            CHECK(stats.tick_rate == 10.0);
+        }
+    }
+}